@@ -57,6 +57,7 @@ namespace ushell
   ush_test::~ush_test ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   int
@@ -90,6 +91,7 @@ namespace ushell
   ush_mem_dump::~ush_mem_dump ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   int
@@ -116,7 +118,7 @@ namespace ushell
             sscanf (argv[2], "%d", &len);
           }
 
-        while (len > 0)
+        while (len > 0 && !ush->cancelled ())
           {
             int count;
 
@@ -0,0 +1,206 @@
+/*
+ * bench.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#ifndef HOST_BENCH_BENCH_H_
+#define HOST_BENCH_BENCH_H_
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// A minimal benchmark runner. BENCH () defines and registers a case; the
+// case sets up what it needs, then loops on state.next (), which times the
+// loop only. Each case is run with more iterations until it takes long
+// enough to be measured. run_benchmarks () prints the results as JSON, in
+// the order the cases are defined:
+//
+//   { "benchmarks": [
+//     { "name": "...", "iterations": n, "ns_per_op": x,
+//       "bytes_per_op": b, "bytes_per_s": y, <counters> }, ... ] }
+//
+// bytes_per_op is what the case says one operation processes; a case may
+// add counters of its own, per operation, e.g. writes to the driver.
+
+namespace bench
+{
+  class state
+  {
+  public:
+
+    state (long iterations) :
+        iterations_
+          { iterations }
+    {
+    }
+
+    // true while there are iterations to run; times them
+    bool
+    next (void)
+    {
+      if (done_ == 0)
+        {
+          start_ = std::chrono::steady_clock::now ();
+        }
+      if (done_ < iterations_)
+        {
+          done_++;
+          return true;
+        }
+      elapsed_ = std::chrono::steady_clock::now () - start_;
+      return false;
+    }
+
+    long
+    iterations (void) const
+    {
+      return iterations_;
+    }
+
+    double
+    seconds (void) const
+    {
+      return elapsed_.count ();
+    }
+
+    // bytes processed by one operation
+    void
+    set_bytes (double bytes)
+    {
+      bytes_ = bytes;
+    }
+
+    double
+    bytes (void) const
+    {
+      return bytes_;
+    }
+
+    // a named count, per operation
+    void
+    set_counter (const char* name, double value)
+    {
+      counters_ += std::string (", \"") + name + "\": ";
+      char num[32];
+      snprintf (num, sizeof(num), "%.2f", value);
+      counters_ += num;
+    }
+
+    const std::string&
+    counters (void) const
+    {
+      return counters_;
+    }
+
+  private:
+
+    long iterations_;
+    long done_ = 0;
+    double bytes_ = 0;
+    std::string counters_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::duration<double> elapsed_
+      { 0 };
+  };
+
+  typedef void
+  (*bench_fn_t) (state& st);
+
+  struct bench_case
+  {
+    const char* name;
+    bench_fn_t fn;
+    bench_case* next;
+  };
+
+  inline bench_case*&
+  first (void)
+  {
+    static bench_case* first = nullptr;
+    return first;
+  }
+
+  struct registrar
+  {
+    registrar (bench_case* bc)
+    {
+      bench_case** pp = &first ();
+      while (*pp != nullptr)
+        {
+          pp = &(*pp)->next;
+        }
+      *pp = bc;
+    }
+  };
+
+  // run the cases whose name contains filter (all if nullptr)
+  inline int
+  run_benchmarks (const char* filter = nullptr, double min_time = 0.2)
+  {
+    const char* sep = "";
+
+    printf ("{ \"benchmarks\": [");
+    for (bench_case* bc = first (); bc != nullptr; bc = bc->next)
+      {
+        if (filter != nullptr && strstr (bc->name, filter) == nullptr)
+          {
+            continue;
+          }
+        for (long n = 1;; n *= 4)
+          {
+            state st
+              { n };
+            bc->fn (st);
+            if (st.seconds () >= min_time || n >= (1L << 30))
+              {
+                double ns = st.seconds () * 1e9 / n;
+                printf ("%s\n  { \"name\": \"%s\", \"iterations\": %ld, "
+                        "\"ns_per_op\": %.1f, \"bytes_per_op\": %.1f, "
+                        "\"bytes_per_s\": %.0f%s }",
+                        sep, bc->name, n, ns, st.bytes (),
+                        st.bytes () * n / st.seconds (),
+                        st.counters ().c_str ());
+                fflush (stdout);
+                break;
+              }
+          }
+        sep = ",";
+      }
+    printf ("\n] }\n");
+    return 0;
+  }
+}
+
+#define BENCH(name) \
+  static void name (bench::state& st); \
+  static bench::bench_case name##_case = { #name, name, nullptr }; \
+  static bench::registrar name##_reg { &name##_case }; \
+  static void name (bench::state& st)
+
+#endif /* HOST_BENCH_BENCH_H_ */
@@ -0,0 +1,172 @@
+/*
+ * mem-tty.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#ifndef HOST_BENCH_MEM_TTY_H_
+#define HOST_BENCH_MEM_TTY_H_
+
+#include <chrono>
+#include <string>
+
+#include <tty-canonical.h>
+
+// A tty driver in memory, to measure the shell's own code without system
+// calls: reads replay a script over and over, in chunks of at most chunk
+// bytes (as from a terminal, keystroke by keystroke with chunk 1), or just
+// once, then fail as if the line hung up; writes are counted, the time of
+// the first one kept, and dropped. With chunk 1, the writes caused by a
+// range of the script's bytes can be counted apart, see watch ().
+
+class mem_tty_impl : public os::posix::tty_timed_impl
+{
+public:
+
+  mem_tty_impl (void)
+  {
+    memset (&tio_, 0, sizeof(tio_));
+    tio_.c_cflag = CS8 | CREAD;
+    tio_.c_cc[VMIN] = 1;
+  }
+
+  void
+  script (const std::string& input, std::size_t chunk = 64, bool loop = true)
+  {
+    input_ = input;
+    pos_ = 0;
+    chunk_ = chunk;
+    loop_ = loop;
+  }
+
+  // replay the script from its start
+  void
+  rewind (void)
+  {
+    pos_ = 0;
+  }
+
+  // count apart the writes made after reading the script's bytes from
+  // index from up to, but not including, index to
+  void
+  watch (std::size_t from, std::size_t to)
+  {
+    wfrom_ = from;
+    wto_ = to;
+  }
+
+  virtual ssize_t
+  do_read (void* buf, std::size_t nbyte)
+  {
+    if (input_.empty () || (!loop_ && pos_ == input_.size ()))
+      {
+        errno = EIO;
+        return -1;
+      }
+    std::size_t n = std::min (nbyte, std::min (chunk_, input_.size () - pos_));
+    memcpy (buf, input_.data () + pos_, n);
+    pos_ += n;
+    if (loop_)
+      {
+        pos_ %= input_.size ();
+      }
+    return n;
+  }
+
+  virtual ssize_t
+  do_write (const void*, std::size_t nbyte)
+  {
+    if (writes == 0)
+      {
+        first_write = std::chrono::steady_clock::now ();
+      }
+    writes++;
+    written += nbyte;
+    if (pos_ > wfrom_ && pos_ <= wto_)
+      {
+        watched_writes++;
+        watched_written += nbyte;
+      }
+    return nbyte;
+  }
+
+  virtual int
+  do_tcgetattr (struct termios* ptio)
+  {
+    memcpy (ptio, &tio_, sizeof(struct termios));
+    return 0;
+  }
+
+  virtual int
+  do_tcsetattr (int, const struct termios* ptio)
+  {
+    memcpy (&tio_, ptio, sizeof(struct termios));
+    return 0;
+  }
+
+  virtual int
+  do_tcflush (int)
+  {
+    return 0;
+  }
+
+  virtual int
+  do_tcsendbreak (int)
+  {
+    return 0;
+  }
+
+  virtual int
+  do_tcdrain (void)
+  {
+    return 0;
+  }
+
+  virtual bool
+  do_rx_wait (os::rtos::clock::duration_t)
+  {
+    return !input_.empty ();
+  }
+
+  unsigned long writes = 0;
+  unsigned long written = 0;
+  std::chrono::steady_clock::time_point first_write;
+  unsigned long watched_writes = 0;
+  unsigned long watched_written = 0;
+
+private:
+
+  struct termios tio_;
+  std::string input_;
+  std::size_t pos_ = 0;
+  std::size_t chunk_ = 64;
+  bool loop_ = true;
+  std::size_t wfrom_ = 0;
+  std::size_t wto_ = 0;
+
+};
+
+#endif /* HOST_BENCH_MEM_TTY_H_ */
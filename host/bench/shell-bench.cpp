@@ -0,0 +1,460 @@
+/*
+ * shell-bench.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include "ushell.h"
+#include "tokenizer.h"
+#include "optparse.h"
+#include "mem-tty.h"
+#include "bench.h"
+
+#ifndef countof
+#define countof(arr)  (sizeof(arr)/sizeof(arr[0]))
+#endif
+
+using ushell::ushell_cmd;
+using ushell::read_line;
+using ushell::buffer_sink;
+using ushell::path;
+using ushell::opt_parse;
+using ushell::tokenizer;
+using os::posix::tty_canonical;
+
+namespace
+{
+  // a command doing nothing, to measure the shell around it
+  class ush_nop : public ushell_cmd
+  {
+  public:
+
+    ush_nop (void)
+    {
+      info_.command = "nop";
+      info_.help_text = "Do nothing";
+    }
+
+    virtual
+    ~ush_nop () noexcept
+    {
+      ushell::ushell::unlink_cmd (this);
+    }
+
+    virtual int
+    do_cmd (ushell::ushell*, int, char*[])
+    {
+      return ushell::ush_ok;
+    }
+
+  } nop;
+
+  // a tty over the memory driver, set up with the given flags on top of
+  // a raw, blocking one
+  struct mem_tty
+  {
+    mem_tty (tcflag_t iflag, tcflag_t oflag, tcflag_t lflag)
+    {
+      struct termios tio;
+      tty.tcgetattr (&tio);
+      tio.c_iflag = iflag;
+      tio.c_oflag = oflag;
+      tio.c_lflag = lflag;
+      tio.c_cc[VMIN] = 1;
+      tio.c_cc[VTIME] = 0;
+      tty.tcsetattr (TCSANOW, &tio);
+    }
+
+    mem_tty_impl impl;
+    tty_canonical tty
+      { impl, "bench" };
+  };
+
+  // type the script, one line per operation
+  void
+  type_lines (bench::state& st, read_line& rl, mem_tty& t,
+              const std::string& script, std::size_t chunk, int lines = 1)
+  {
+    char buf[SHELL_MAX_LINE_LEN];
+
+    t.impl.script (script, chunk);
+    rl.initialise (&t.tty);
+    t.impl.writes = t.impl.written = 0;
+    while (st.next ())
+      {
+        rl.readline ("> ", buf, sizeof(buf));
+      }
+    st.set_bytes ((double) script.size () / lines);
+    st.set_counter ("writes_per_op",
+                    (double) t.impl.writes / st.iterations ());
+    st.set_counter ("bytes_written_per_op",
+                    (double) t.impl.written / st.iterations ());
+  }
+
+  // type the setup, then the edit keys, then enter, one line per operation;
+  // what the edit keys cause on the wire is reported per key
+  void
+  edit_keys (bench::state& st, read_line& rl, mem_tty& t,
+             const std::string& setup, const std::string& edits, int keys)
+  {
+    t.impl.watch (setup.size (), setup.size () + edits.size ());
+    type_lines (st, rl, t, setup + edits + "\r", 1);
+    st.set_counter ("writes_per_edit",
+                    (double) t.impl.watched_writes / st.iterations () / keys);
+    st.set_counter ("bytes_per_edit",
+                    (double) t.impl.watched_written / st.iterations () / keys);
+  }
+
+  // a long line, a command with its arguments, as edited in the middle
+  const std::string long_line =
+      "cp -r /flash/logs/2026/october/16/history.txt /flash/backup/2026/"
+      "october/16/history-copy.txt -v";
+
+  char history[1024];
+
+  // the argument loop of cmd_parser () in ushell 0.4.x, for comparison:
+  // double quotes only at the start of an argument, no escapes
+  int
+  legacy_split (char* buff, char* argv[], int max)
+  {
+    char* pbuff = buff;
+    int argc;
+
+    while (*pbuff != ' ' && *pbuff != '\0')
+      {
+        pbuff++;
+      }
+    *pbuff++ = '\0';
+    argv[0] = buff;
+
+    for (argc = 1; argc < max; argc++)
+      {
+        if (*pbuff == '\0')
+          {
+            break;
+          }
+        if (*pbuff == '\"')
+          {
+            pbuff++;
+            argv[argc] = pbuff;
+            while (*pbuff != '\"' && *pbuff != '\0')
+              {
+                pbuff++;
+              }
+            *pbuff++ = '\0';
+            if (*pbuff != '\0')
+              {
+                pbuff++;
+              }
+          }
+        else
+          {
+            while (*pbuff == ' ' || *pbuff == '\t')
+              {
+                pbuff++;
+              }
+            if (*pbuff == '\0')
+              {
+                break;
+              }
+            argv[argc] = pbuff;
+            while (*pbuff != ' ' && *pbuff != '\0')
+              {
+                pbuff++;
+              }
+            *pbuff++ = '\0';
+          }
+      }
+    argv[argc] = nullptr;
+    return argc;
+  }
+
+  constexpr int max_args = 10; // as in ushell.cpp
+
+  // a line both parsers split the same way
+  const char split_line[] =
+      "cp -r \"/flash/my documents\" /flash/backup/2026 -v --force";
+}
+
+// a command line, from the redirection and pipe scan to the command
+BENCH(cmd_parser)
+{
+  ushell::ushell sh
+    { "/dev/none" };
+  const char line[] = "nop -v --name 'a quoted arg' \"x\\\"y\" one two three";
+  char buf[sizeof(line)];
+  char out[64];
+  buffer_sink sink
+    { out, sizeof(out) };
+
+  while (st.next ())
+    {
+      memcpy (buf, line, sizeof(line));
+      sh.exec (buf, &sink);
+    }
+  st.set_bytes (sizeof(line) - 1);
+}
+
+// the tokenizer alone, on a line the old loop splits the same way
+BENCH(tokenizer_split)
+{
+  char buf[sizeof(split_line)];
+  char* argv[max_args + 1];
+
+  while (st.next ())
+    {
+      memcpy (buf, split_line, sizeof(split_line));
+      tokenizer::split (buf, argv, max_args + 1);
+    }
+  st.set_bytes (sizeof(split_line) - 1);
+}
+
+BENCH(legacy_parser_loop)
+{
+  char buf[sizeof(split_line)];
+  char* argv[max_args + 1];
+
+  while (st.next ())
+    {
+      memcpy (buf, split_line, sizeof(split_line));
+      legacy_split (buf, argv, max_args);
+    }
+  st.set_bytes (sizeof(split_line) - 1);
+}
+
+// text typed key by key: text runs, echo
+BENCH(readline_insert)
+{
+  mem_tty t
+    { 0, OPOST | ONLCR, 0 };
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  type_lines (st, rl, t, "the quick brown fox jumps over the lazy dog\r", 1);
+}
+
+// editing keys, key by key: sequence matching, cursor moves, redraws
+BENCH(readline_edit)
+{
+  mem_tty t
+    { 0, OPOST | ONLCR, 0 };
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  type_lines (st, rl, t, "ls -l /flash/logs\033[D\033[D\033[Dxy\001\033f\x7F"
+             "\033[1;5C\033[3~\005 | wc\r",
+             1);
+}
+
+// a different line each time, all into the history, with evictions
+BENCH(readline_history_add)
+{
+  mem_tty t
+    { 0, OPOST | ONLCR, 0 };
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  std::string script;
+  for (int i = 0; i < 64; i++)
+    {
+      char line[48];
+      snprintf (line, sizeof(line), "cat /flash/logs/entry-%02d.txt\r", i);
+      script += line;
+    }
+  type_lines (st, rl, t, script, 64, 64);
+}
+
+// a whole session, from do_ushell () until the tty hangs up: the wait for
+// the first key (SHELL_START_TIMEOUT), the greeting, one command; also the
+// time from the start to the first output
+BENCH(session_start)
+{
+  mem_tty t
+    { 0, 0, 0 };
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  ushell::ushell sh
+    { "/dev/bench", &rl };
+  double first_ns = 0;
+
+  t.impl.script ("nop\r", 64, false);
+  while (st.next ())
+    {
+      t.impl.rewind ();
+      t.impl.writes = 0;
+      std::chrono::steady_clock::time_point start =
+          std::chrono::steady_clock::now ();
+      sh.do_ushell (nullptr);
+      first_ns += std::chrono::duration<double, std::nano> (
+          t.impl.first_write - start).count ();
+    }
+  st.set_counter ("ns_to_first_output", first_ns / st.iterations ());
+}
+
+// a key typed in the middle of a long line: the tail is redrawn
+BENCH(render_insert_midline)
+{
+  mem_tty t
+    { 0, OPOST | ONLCR, 0 };
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  edit_keys (st, rl, t, long_line + "\001" + std::string (48, '\006'),
+             std::string (16, 'x'), 16);
+}
+
+// backspace in the middle of a long line
+BENCH(render_delete_midline)
+{
+  mem_tty t
+    { 0, OPOST | ONLCR, 0 };
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  edit_keys (st, rl, t, long_line + "\001" + std::string (48, '\006'),
+             std::string (16, '\x7F'), 16);
+}
+
+// up and down between two long history entries that differ at the end:
+// only the changed tail is redrawn
+BENCH(render_history_swap)
+{
+  static char hist[1024];
+  memset (hist, 0, sizeof(hist));
+  mem_tty t
+    { 0, OPOST | ONLCR, 0 };
+  read_line rl
+    { nullptr, hist, sizeof(hist) };
+  char buf[SHELL_MAX_LINE_LEN];
+
+  t.impl.script (long_line + "\r" + long_line + "f\r");
+  rl.initialise (&t.tty);
+  rl.readline ("> ", buf, sizeof(buf));
+  rl.readline ("> ", buf, sizeof(buf));
+
+  std::string edits;
+  for (int i = 0; i < 8; i++)
+    {
+      edits += "\033[A\033[B";
+    }
+  edit_keys (st, rl, t, "\033[A", edits, 16);
+}
+
+// a line of output, with NL to CR NL mapping
+BENCH(tty_put_line)
+{
+  mem_tty t
+    { 0, OPOST | ONLCR, 0 };
+  const char line[] =
+      "-rw-r--r--    1 root  root      4096 Oct 16 12:00 history.txt\n";
+
+  t.impl.writes = 0;
+  while (st.next ())
+    {
+      t.tty.write (line, sizeof(line) - 1);
+    }
+  st.set_bytes (sizeof(line) - 1);
+  st.set_counter ("writes_per_op", (double) t.impl.writes / st.iterations ());
+}
+
+// a canonical line read, with echo
+BENCH(tty_get_line)
+{
+  mem_tty t
+    { ICRNL, OPOST | ONLCR, ICANON | ECHO | ECHOE };
+  const std::string line = "ls -l /flash/logs/history.txt\r";
+  char buf[128];
+
+  t.impl.script (line);
+  t.impl.writes = 0;
+  while (st.next ())
+    {
+      t.tty.read (buf, sizeof(buf));
+    }
+  st.set_bytes (line.size ());
+  st.set_counter ("writes_per_op", (double) t.impl.writes / st.iterations ());
+}
+
+// raw input through the translation table (CR to NL), a chunk per read
+BENCH(tty_process_input)
+{
+  mem_tty t
+    { ICRNL | INLCR, 0, 0 };
+  std::string chunk (64, 'x');
+  for (std::size_t i = 7; i < chunk.size (); i += 8)
+    {
+      chunk[i] = '\r';
+    }
+  char buf[64];
+
+  t.impl.script (chunk, chunk.size ());
+  while (st.next ())
+    {
+      t.tty.read (buf, sizeof(buf));
+    }
+  st.set_bytes (chunk.size ());
+}
+
+BENCH(path_to_absolute)
+{
+  path ph;
+  const char rel[] = "../logs/./2026/../history.txt";
+  char result[260];
+
+  ph.set_default ("/flash/");
+  ph.forward ("data", result, sizeof(result));
+  while (st.next ())
+    {
+      ph.to_absolute (rel, result, sizeof(result));
+    }
+  st.set_bytes (sizeof(rel) - 1);
+}
+
+BENCH(optparse)
+{
+  const char* args[] =
+    { "cp", "-v", "-r", "-o", "out.txt", "src", "-f", "dst" };
+  std::size_t bytes = 0;
+  for (const char* a : args)
+    {
+      bytes += strlen (a) + 1;
+    }
+
+  while (st.next ())
+    {
+      char* argv[countof(args) + 1];
+      memcpy (argv, args, sizeof(args));
+      argv[countof(args)] = nullptr;
+      opt_parse op
+        { countof(args), argv };
+      while (op.optparse ("vrfo:") != -1)
+        {
+          ;
+        }
+    }
+  st.set_bytes (bytes);
+}
+
+int
+main (int argc, char* argv[])
+{
+  return bench::run_benchmarks (argc > 1 ? argv[1] : nullptr);
+}
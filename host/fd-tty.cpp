@@ -0,0 +1,179 @@
+/*
+ * fd-tty.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <poll.h>
+
+#include "fd-tty.h"
+
+namespace os
+{
+  namespace posix
+  {
+
+    /**
+     * @brief Constructor.
+     * @param rfd: descriptor to read from.
+     * @param wfd: descriptor to write to, may be the same.
+     */
+    fd_tty_impl::fd_tty_impl (int rfd, int wfd) :
+        rfd_
+          { rfd }, //
+        wfd_
+          { wfd }
+    {
+      memset (&tio_, 0, sizeof(tio_));
+      tio_.c_cflag = CS8 | CREAD;
+      tio_.c_cc[VMIN] = 1;
+    }
+
+    /**
+     * @brief Read what is available, waiting for the first byte; with
+     *  VMIN = 0, waiting at most VTIME tenths of a second.
+     * @return Number of bytes read, 0 if none with VMIN 0, -1 on error or
+     *  when the peer is gone.
+     */
+    ssize_t
+    fd_tty_impl::do_read (void* buf, std::size_t nbyte)
+    {
+      if (tio_.c_cc[VMIN] == 0
+          && !do_rx_wait (
+              tio_.c_cc[VTIME] * os::rtos::sysclock.frequency_hz / 10))
+        {
+          return 0;
+        }
+
+      ssize_t n;
+      while ((n = ::read (rfd_, buf, nbyte)) < 0 && errno == EINTR)
+        {
+          ;
+        }
+      if (n == 0)
+        {
+          errno = EIO; // hung up
+          n = -1;
+        }
+
+      return n;
+    }
+
+    /**
+     * @brief Write all the data.
+     * @return Number of bytes written, -1 on error.
+     */
+    ssize_t
+    fd_tty_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+      const char* p = static_cast<const char*> (buf);
+      std::size_t left = nbyte;
+
+      while (left)
+        {
+          ssize_t n = ::write (wfd_, p, left);
+          if (n < 0)
+            {
+              if (errno == EINTR)
+                {
+                  continue;
+                }
+              return -1;
+            }
+          p += n;
+          left -= n;
+        }
+
+      return nbyte;
+    }
+
+    int
+    fd_tty_impl::do_tcgetattr (struct termios* ptio)
+    {
+      memcpy (ptio, &tio_, sizeof(struct termios));
+      return 0;
+    }
+
+    int
+    fd_tty_impl::do_tcsetattr (int options, const struct termios* ptio)
+    {
+      (void) options;
+      memcpy (&tio_, ptio, sizeof(struct termios));
+      setattr_count_ = setattr_count_ + 1;
+      return 0;
+    }
+
+    int
+    fd_tty_impl::do_tcflush (int queue_selector)
+    {
+      if (queue_selector == TCIFLUSH || queue_selector == TCIOFLUSH)
+        {
+          char c[64];
+          while (do_rx_wait (0) && ::read (rfd_, c, sizeof(c)) > 0)
+            {
+              ;
+            }
+        }
+      return 0;
+    }
+
+    int
+    fd_tty_impl::do_tcsendbreak (int duration)
+    {
+      (void) duration;
+      return 0;
+    }
+
+    int
+    fd_tty_impl::do_tcdrain (void)
+    {
+      return 0;
+    }
+
+    /**
+     * @brief Wait for the descriptor to become readable; a hang up counts
+     *  as readable, the read then fails.
+     * @param timeout: maximum time to wait, in system ticks.
+     * @return true if a read would not block.
+     */
+    bool
+    fd_tty_impl::do_rx_wait (os::rtos::clock::duration_t timeout)
+    {
+      struct pollfd pfd =
+        { rfd_, POLLIN, 0 };
+      int ms = timeout * 1000 / os::rtos::sysclock.frequency_hz;
+      int n;
+
+      while ((n = ::poll (&pfd, 1, ms)) < 0 && errno == EINTR)
+        {
+          ;
+        }
+
+      return n > 0;
+    }
+
+  } /* namespace posix */
+} /* namespace os */
@@ -0,0 +1,110 @@
+/*
+ * fd-tty.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * A tty driver over a pair of file descriptors (the terminal, a pty or a
+ * socket), for the host build.
+ */
+
+#ifndef HOST_FD_TTY_H_
+#define HOST_FD_TTY_H_
+
+#include <tty-canonical.h>
+
+#if defined (__cplusplus)
+
+namespace os
+{
+  namespace posix
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief A tty driver over host file descriptors: a pty, a socket or
+     *  a pair of pipes. The descriptors are not closed by the driver.
+     *  VMIN and VTIME are honoured only as far as tty_canonical uses them,
+     *  i.e. with VMIN = 0 a read waits at most VTIME for the first byte.
+     */
+    class fd_tty_impl : public tty_timed_impl
+    {
+    public:
+
+      fd_tty_impl (int rfd, int wfd);
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte);
+
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte);
+
+      virtual int
+      do_tcgetattr (struct termios* ptio);
+
+      virtual int
+      do_tcsetattr (int options, const struct termios* ptio);
+
+      virtual int
+      do_tcflush (int queue_selector);
+
+      virtual int
+      do_tcsendbreak (int duration);
+
+      virtual int
+      do_tcdrain (void);
+
+      virtual bool
+      do_rx_wait (os::rtos::clock::duration_t timeout);
+
+      // number of do_tcsetattr () calls so far
+      unsigned int
+      setattr_count (void) const;
+
+    private:
+
+      int rfd_;
+      int wfd_;
+      struct termios tio_;
+      volatile unsigned int setattr_count_ = 0;
+
+    };
+
+    /**
+     * @brief Return the number of times the driver was reconfigured.
+     */
+    inline unsigned int
+    fd_tty_impl::setattr_count (void) const
+    {
+      return setattr_count_;
+    }
+
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* HOST_FD_TTY_H_ */
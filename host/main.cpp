@@ -0,0 +1,159 @@
+/*
+ * main.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * The shell on the host: on the terminal, or with -p on a pseudo-terminal,
+ * to be reached with e.g. picocom or screen. The file system is a directory
+ * (-r, the current one by default).
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/file-system.h>
+#include <cmsis-plus/posix-io/chan-fatfs-file-system.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "ushell.h"
+#include "rtc-drv.h"
+#include "fd-tty.h"
+
+using namespace os;
+
+// expected by the file and built-in commands
+posix::chan_fatfs_file_system_lockable<rtos::mutex> fat_fs
+  { "fat" };
+rtc my_rtc;
+
+namespace
+{
+  struct termios saved;
+  bool restore = false;
+
+  void
+  usage (const char* name)
+  {
+    fprintf (stderr, "Usage: %s [-p] [-r root]\n"
+             "  -p       serve on a pseudo-terminal instead of stdin/stdout\n"
+             "  -r root  host directory standing for / (default .)\n",
+             name);
+  }
+
+  void
+  tty_restore (void)
+  {
+    if (restore)
+      {
+        ::tcsetattr (STDIN_FILENO, TCSANOW, &saved);
+      }
+  }
+}
+
+/**
+ * @brief Run the shell on the host, over the terminal it was started from
+ *  or over a pseudo-terminal, with the files below a host directory; the
+ *  shell's "/flash" is created there if missing.
+ */
+int
+main (int argc, char* argv[])
+{
+  const char* root = ".";
+  bool pty = false;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "pr:")) != -1)
+    {
+      switch (opt)
+        {
+        case 'p':
+          pty = true;
+          break;
+        case 'r':
+          root = optarg;
+          break;
+        default:
+          usage (argv[0]);
+          return 1;
+        }
+    }
+
+  posix::host_root (root);
+  posix::mkdir ("/flash", 0);
+
+  int rfd = STDIN_FILENO, wfd = STDOUT_FILENO;
+  if (pty)
+    {
+      if ((rfd = posix_openpt (O_RDWR | O_NOCTTY)) < 0 || grantpt (rfd) < 0
+          || unlockpt (rfd) < 0)
+        {
+          perror ("pty");
+          return 1;
+        }
+      wfd = rfd;
+
+      // hold the other side open, so that the shell does not see a hang
+      // up between two clients, and pass everything through
+      struct termios tio;
+      int sfd = open (ptsname (rfd), O_RDWR | O_NOCTTY);
+      if (sfd < 0 || ::tcgetattr (sfd, &tio) < 0)
+        {
+          perror ("pty");
+          return 1;
+        }
+      cfmakeraw (&tio);
+      ::tcsetattr (sfd, TCSANOW, &tio);
+
+      printf ("ushell on %s\n", ptsname (rfd));
+      fflush (stdout);
+    }
+  else if (isatty (STDIN_FILENO) && ::tcgetattr (STDIN_FILENO, &saved) == 0)
+    {
+      // the line discipline is the shell's, the terminal passes all through
+      struct termios tio = saved;
+      cfmakeraw (&tio);
+      ::tcsetattr (STDIN_FILENO, TCSANOW, &tio);
+      restore = true;
+      atexit (tty_restore);
+    }
+
+  posix::tty_canonical_implementable<posix::fd_tty_impl> tty
+    { "host", rfd, wfd };
+  ushell::read_line rl
+    { nullptr, "/flash/.history" };
+  ushell::ushell ush
+    { "/dev/host", &rl };
+
+  // on a pty, "exit" starts a new session; the program runs until killed
+  do
+    {
+      ush.do_ushell (nullptr);
+    }
+  while (pty);
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * trace.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * Host stand-in for the µOS++ header of the same name, with only what the
+ * shell uses.
+ */
+
+#ifndef CMSIS_PLUS_DIAG_TRACE_H_
+#define CMSIS_PLUS_DIAG_TRACE_H_
+
+#include <cstdarg>
+
+#if defined (__cplusplus)
+
+namespace os
+{
+  namespace trace
+  {
+    // to stderr if USHELL_TRACE is set in the environment, else nowhere
+    int
+    printf (const char* format, ...);
+
+    int
+    vprintf (const char* format, std::va_list args);
+
+    int
+    puts (const char* s);
+  }
+}
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_DIAG_TRACE_H_ */
@@ -0,0 +1,142 @@
+/*
+ * chan-fatfs-file-system.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * Host stand-in for the µOS++ header of the same name, with only what the
+ * shell uses.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_CHAN_FATFS_FILE_SYSTEM_H_
+#define CMSIS_PLUS_POSIX_IO_CHAN_FATFS_FILE_SYSTEM_H_
+
+#include <cmsis-plus/posix-io/file-system.h>
+
+// mkfs () options, as in FatFS
+#define FM_FAT 0x01
+#define FM_FAT32 0x02
+#define FM_EXFAT 0x04
+#define FM_ANY 0x07
+#define FM_SFD 0x08
+
+#if defined (__cplusplus)
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    class block_device
+    {
+    public:
+
+      int
+      open (void)
+      {
+        return 0;
+      }
+
+      int
+      close (void)
+      {
+        return 0;
+      }
+
+      std::size_t
+      block_logical_size_bytes (void)
+      {
+        return 512;
+      }
+    };
+
+    // ========================================================================
+
+    // The host file system is always there: mounting does nothing, and
+    // formatting is refused.
+    template<typename L>
+      class chan_fatfs_file_system_lockable
+      {
+      public:
+
+        chan_fatfs_file_system_lockable (const char* name) :
+            name_
+              { name }
+        {
+        }
+
+        int
+        mount (const char* path = nullptr, unsigned int flags = 0)
+        {
+          (void) path;
+          (void) flags;
+          return 0;
+        }
+
+        int
+        umount (int flags = 0)
+        {
+          (void) flags;
+          return 0;
+        }
+
+        int
+        mkfs (int options, std::size_t au, std::size_t n_fat, void* buf,
+              std::size_t len)
+        {
+          (void) options;
+          (void) au;
+          (void) n_fat;
+          (void) buf;
+          (void) len;
+          errno = ENOSYS;
+          return -1;
+        }
+
+        block_device&
+        device (void)
+        {
+          return device_;
+        }
+
+        const char*
+        name (void) const
+        {
+          return name_;
+        }
+
+      private:
+
+        const char* name_;
+        block_device device_;
+      };
+
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_CHAN_FATFS_FILE_SYSTEM_H_ */
@@ -0,0 +1,105 @@
+/*
+ * file-system.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * Host stand-in for the µOS++ header of the same name, with only what the
+ * shell uses.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_FILE_SYSTEM_H_
+#define CMSIS_PLUS_POSIX_IO_FILE_SYSTEM_H_
+
+#include <cmsis-plus/posix-io/io.h>
+
+#if defined (__cplusplus)
+
+namespace os
+{
+  namespace posix
+  {
+    // Host only: the directory standing for "/" in the paths of the shell;
+    // "." when not set.
+    void
+    host_root (const char* dir);
+
+    // ========================================================================
+
+    class directory
+    {
+    public:
+
+      directory (DIR* dir);
+
+      directory (const directory&) = delete;
+
+      directory&
+      operator= (const directory&) = delete;
+
+      ~directory ();
+
+      struct dirent*
+      read (void);
+
+      // also frees the object
+      int
+      close (void);
+
+    private:
+
+      DIR* dir_;
+
+    };
+
+    // ------------------------------------------------------------------------
+
+    directory*
+    opendir (const char* dirname);
+
+    int
+    stat (const char* path, struct stat* buf);
+
+    int
+    mkdir (const char* path, mode_t mode);
+
+    int
+    rmdir (const char* path);
+
+    int
+    unlink (const char* path);
+
+    int
+    rename (const char* existing, const char* _new);
+
+    int
+    statvfs (const char* path, struct statvfs* buf);
+
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_FILE_SYSTEM_H_ */
@@ -0,0 +1,172 @@
+/*
+ * io.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * Host stand-in for the µOS++ header of the same name, with only what the
+ * shell uses.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_IO_H_
+#define CMSIS_PLUS_POSIX_IO_IO_H_
+
+#include <cmsis-plus/rtos/os.h>
+#include <cstdarg>
+#include <unistd.h>
+#include <fcntl.h>
+
+#if defined (__cplusplus)
+
+namespace os
+{
+  namespace posix
+  {
+    class io;
+    class io_impl;
+
+    // "/dev/<name>" opens the tty registered with that name, any other
+    // path a file below the root set with host_root ()
+    io*
+    open (const char* path, int oflag, ...);
+
+    io*
+    vopen (const char* path, int oflag, std::va_list args);
+
+    // ========================================================================
+
+    class io
+    {
+    public:
+
+      typedef unsigned int type_t;
+
+      enum class type
+        : type_t
+          {
+            unknown = 0,
+            not_set = 1 << 0,
+            char_device = 1 << 1,
+            block_device = 1 << 2,
+            tty = 1 << 3,
+            file = 1 << 4,
+            socket = 1 << 5
+      };
+
+      io (io_impl& impl, type t);
+
+      io (const io&) = delete;
+
+      io&
+      operator= (const io&) = delete;
+
+      virtual
+      ~io () noexcept;
+
+      virtual int
+      close (void);
+
+      virtual ssize_t
+      read (void* buf, std::size_t nbyte);
+
+      virtual ssize_t
+      write (const void* buf, std::size_t nbyte);
+
+      virtual off_t
+      lseek (off_t offset, int whence);
+
+      virtual int
+      fstat (struct stat* buf);
+
+      type_t
+      get_type (void) const;
+
+      io_impl&
+      impl (void) const;
+
+    protected:
+
+      type_t type_ = static_cast<type_t> (type::not_set);
+      io_impl& impl_;
+
+    };
+
+    // ========================================================================
+
+    class io_impl
+    {
+    public:
+
+      io_impl (void) = default;
+
+      io_impl (const io_impl&) = delete;
+
+      io_impl&
+      operator= (const io_impl&) = delete;
+
+      virtual
+      ~io_impl ();
+
+      // called by open () on each open of a device
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args);
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) = 0;
+
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) = 0;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence);
+
+      virtual int
+      do_fstat (struct stat* buf);
+
+      virtual int
+      do_close (void);
+
+    };
+
+    // ========================================================================
+
+    inline io_impl&
+    io::impl (void) const
+    {
+      return impl_;
+    }
+
+    inline io::type_t
+    io::get_type (void) const
+    {
+      return type_;
+    }
+
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_IO_H_ */
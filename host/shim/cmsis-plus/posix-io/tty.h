@@ -0,0 +1,128 @@
+/*
+ * tty.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * Host stand-in for the µOS++ header of the same name, with only what the
+ * shell uses.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_TTY_H_
+#define CMSIS_PLUS_POSIX_IO_TTY_H_
+
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix/termios.h>
+
+#if defined (__cplusplus)
+
+namespace os
+{
+  namespace posix
+  {
+    class tty_impl;
+
+    // ========================================================================
+
+    class tty : public io
+    {
+    public:
+
+      // registered as "/dev/<name>" until destroyed
+      tty (tty_impl& impl, const char* name);
+
+      virtual
+      ~tty () noexcept;
+
+      virtual int
+      tcgetattr (struct termios* ptio) = 0;
+
+      virtual int
+      tcsetattr (int options, const struct termios* ptio) = 0;
+
+      virtual int
+      tcflush (int queue_selector) = 0;
+
+      virtual int
+      tcsendbreak (int duration) = 0;
+
+      virtual int
+      tcdrain (void) = 0;
+
+      const char*
+      name (void) const;
+
+      // the tty registered with the given name, or nullptr
+      static tty*
+      identify_device (const char* name);
+
+    protected:
+
+      const char* name_;
+
+    private:
+
+      tty* next_ = nullptr;
+      static tty* first_;
+
+    };
+
+    // ========================================================================
+
+    class tty_impl : public io_impl
+    {
+    public:
+
+      virtual int
+      do_tcgetattr (struct termios* ptio) = 0;
+
+      virtual int
+      do_tcsetattr (int options, const struct termios* ptio) = 0;
+
+      virtual int
+      do_tcflush (int queue_selector) = 0;
+
+      virtual int
+      do_tcsendbreak (int duration) = 0;
+
+      virtual int
+      do_tcdrain (void) = 0;
+
+    };
+
+    // ========================================================================
+
+    inline const char*
+    tty::name (void) const
+    {
+      return name_;
+    }
+
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_TTY_H_ */
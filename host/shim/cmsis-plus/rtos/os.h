@@ -0,0 +1,402 @@
+/*
+ * os.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * Host stand-in for the µOS++ header of the same name, with only what the
+ * shell uses.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_H_
+#define CMSIS_PLUS_RTOS_OS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdarg>
+#include <cctype>
+#include <cassert>
+#include <ctime>
+#include <cerrno>
+#include <utility>
+#include <algorithm>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <dirent.h>
+#include <strings.h>
+#include <pthread.h>
+
+#if defined (__cplusplus)
+
+namespace os
+{
+  namespace rtos
+  {
+    typedef uint32_t result_t;
+
+    namespace result
+    {
+      constexpr result_t ok = 0;
+    }
+
+    // ========================================================================
+
+    class clock
+    {
+    public:
+
+      typedef uint32_t duration_t;
+      typedef uint64_t timestamp_t;
+      typedef int64_t offset_t;
+
+      clock (void) = default;
+
+      clock (const clock&) = delete;
+
+      clock&
+      operator= (const clock&) = delete;
+
+      // the steady time plus the offset
+      timestamp_t
+      now (void);
+
+      // since the start of the program
+      timestamp_t
+      steady_now (void);
+
+      result_t
+      sleep_for (duration_t duration);
+
+      offset_t
+      offset (offset_t offset);
+
+      offset_t
+      offset (void);
+
+    protected:
+
+      virtual uint32_t
+      hz (void) const = 0;
+
+      offset_t offset_ = 0;
+
+    };
+
+    class clock_systick : public clock
+    {
+    public:
+
+      static constexpr uint32_t frequency_hz = 1000;
+
+    protected:
+
+      virtual uint32_t
+      hz (void) const;
+
+    };
+
+    class clock_rtc : public clock
+    {
+    public:
+
+      static constexpr uint32_t frequency_hz = 1;
+
+      // starts at the host's time of day
+      clock_rtc (void);
+
+    protected:
+
+      virtual uint32_t
+      hz (void) const;
+
+    };
+
+    extern clock_systick sysclock;
+    extern clock_rtc rtclock;
+
+    // ========================================================================
+
+    class mutex
+    {
+    public:
+
+      class attributes
+      {
+      public:
+
+        bool mx_recursive = false;
+      };
+
+      static const attributes initializer_normal;
+      static const attributes initializer_recursive;
+
+      mutex (const attributes& attr = initializer_normal);
+
+      mutex (const char* name, const attributes& attr = initializer_normal);
+
+      mutex (const mutex&) = delete;
+
+      mutex&
+      operator= (const mutex&) = delete;
+
+      ~mutex ();
+
+      result_t
+      lock (void);
+
+      result_t
+      try_lock (void);
+
+      result_t
+      unlock (void);
+
+    private:
+
+      pthread_mutex_t mx_;
+
+    };
+
+    // ========================================================================
+
+    class semaphore_binary
+    {
+    public:
+
+      semaphore_binary (const char* name, uint32_t initial_value);
+
+      semaphore_binary (const semaphore_binary&) = delete;
+
+      semaphore_binary&
+      operator= (const semaphore_binary&) = delete;
+
+      ~semaphore_binary ();
+
+      result_t
+      post (void);
+
+      result_t
+      wait (void);
+
+      result_t
+      try_wait (void);
+
+      // ETIMEDOUT if not posted within the given number of ticks
+      result_t
+      timed_wait (clock::duration_t timeout);
+
+    private:
+
+      pthread_mutex_t mx_;
+      pthread_cond_t cv_;
+      bool count_;
+
+    };
+
+    // ========================================================================
+
+    class thread
+    {
+    public:
+
+      typedef void*
+      (*func_t) (void* args);
+
+      typedef void* func_args_t;
+
+      typedef uint8_t state_t;
+
+      typedef uint8_t priority_t;
+
+      class attributes
+      {
+      public:
+
+        std::size_t th_stack_size_bytes = 0; // ignored, the host decides
+        priority_t th_priority = 0;
+      };
+
+      static const attributes initializer;
+
+      class stack
+      {
+      public:
+
+        std::size_t
+        size (void);
+
+        std::size_t
+        available (void);
+
+      private:
+
+        friend class thread;
+
+        std::size_t size_ = 0;
+      };
+
+      class statistics
+      {
+      public:
+
+        uint64_t
+        cpu_cycles (void);
+      };
+
+      thread (const char* name, func_t function, func_args_t args,
+              const attributes& attr = initializer);
+
+      thread (const thread&) = delete;
+
+      thread&
+      operator= (const thread&) = delete;
+
+      virtual
+      ~thread ();
+
+      result_t
+      join (void** exit_ptr = nullptr);
+
+      const char*
+      name (void) const;
+
+      state_t
+      state (void) const;
+
+      priority_t
+      priority (void);
+
+      class stack&
+      stack (void);
+
+      class statistics&
+      statistics (void);
+
+    private:
+
+      const char* name_;
+      pthread_t th_;
+      bool joinable_ = false;
+      class stack stack_;
+      class statistics statistics_;
+
+    };
+
+    template<std::size_t N = 0>
+      class thread_inclusive : public thread
+      {
+      public:
+
+        thread_inclusive (const char* name, func_t function, func_args_t args,
+                          const attributes& attr = initializer) :
+            thread
+              { name, function, args, attr }
+        {
+        }
+      };
+
+    // ========================================================================
+
+    namespace scheduler
+    {
+      // one lock for all critical sections; unlike on the target, other
+      // threads keep running, but not within a critical section
+      class critical_section
+      {
+      public:
+
+        critical_section (void);
+
+        critical_section (const critical_section&) = delete;
+
+        critical_section&
+        operator= (const critical_section&) = delete;
+
+        ~critical_section ();
+      };
+
+      // the host threads are not tracked, the list is always empty
+      class threads_list
+      {
+      public:
+
+        thread*
+        begin (void);
+
+        thread*
+        end (void);
+      };
+
+      threads_list&
+      children_threads (thread* th);
+
+      namespace statistics
+      {
+        uint64_t
+        cpu_cycles (void);
+      }
+    }
+
+    namespace interrupts
+    {
+      typedef scheduler::critical_section critical_section;
+    }
+
+    namespace statistics
+    {
+      typedef uint64_t duration_t;
+    }
+
+    namespace this_thread
+    {
+      void
+      yield (void);
+    }
+
+    namespace memory
+    {
+      class memory_resource
+      {
+      public:
+
+        std::size_t
+        total_bytes (void);
+
+        std::size_t
+        free_bytes (void);
+      };
+
+      extern memory_resource* default_resource;
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_H_ */
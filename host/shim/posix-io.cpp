@@ -0,0 +1,404 @@
+/*
+ * posix-io.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * The parts of the µOS++ POSIX I/O API the shell uses: ttys registered by
+ * name under /dev, the rest of the paths mapped to a directory of the host.
+ */
+
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/tty.h>
+#include <cmsis-plus/posix-io/file-system.h>
+
+#include <string>
+
+namespace
+{
+  std::string root = ".";
+
+  /**
+   * @brief Map a path of the shell onto the host file system.
+   */
+  std::string
+  host_path (const char* path)
+  {
+    return root + (*path == '/' ? "" : "/") + path;
+  }
+
+  // ==========================================================================
+
+  class file_impl : public os::posix::io_impl
+  {
+  public:
+
+    file_impl (int fd) :
+        fd_
+          { fd }
+    {
+    }
+
+    virtual ssize_t
+    do_read (void* buf, std::size_t nbyte)
+    {
+      return ::read (fd_, buf, nbyte);
+    }
+
+    virtual ssize_t
+    do_write (const void* buf, std::size_t nbyte)
+    {
+      return ::write (fd_, buf, nbyte);
+    }
+
+    virtual off_t
+    do_lseek (off_t offset, int whence)
+    {
+      return ::lseek (fd_, offset, whence);
+    }
+
+    virtual int
+    do_fstat (struct stat* buf)
+    {
+      return ::fstat (fd_, buf);
+    }
+
+    virtual int
+    do_close (void)
+    {
+      return ::close (fd_);
+    }
+
+  private:
+
+    int fd_;
+  };
+
+  // a file object lives from open () to close ()
+  class file : public os::posix::io
+  {
+  public:
+
+    file (int fd) :
+        io
+          { impl_instance_, type::file }, //
+        impl_instance_
+          { fd }
+    {
+    }
+
+    virtual int
+    close (void)
+    {
+      int result = io::close ();
+
+      delete this;
+      return result;
+    }
+
+  private:
+
+    file_impl impl_instance_;
+  };
+}
+
+namespace os
+{
+  namespace posix
+  {
+    void
+    host_root (const char* dir)
+    {
+      root = dir;
+    }
+
+    // ------------------------------------------------------------------------
+
+    io*
+    open (const char* path, int oflag, ...)
+    {
+      std::va_list args;
+      io* result;
+
+      va_start(args, oflag);
+      result = vopen (path, oflag, args);
+      va_end(args);
+
+      return result;
+    }
+
+    io*
+    vopen (const char* path, int oflag, std::va_list args)
+    {
+      if (path == nullptr)
+        {
+          errno = EFAULT;
+          return nullptr;
+        }
+
+      if (strncmp (path, "/dev/", 5) == 0)
+        {
+          tty* dev = tty::identify_device (path + 5);
+          if (dev == nullptr)
+            {
+              errno = ENOENT;
+              return nullptr;
+            }
+          if (dev->impl ().do_vopen (path, oflag, args) < 0)
+            {
+              return nullptr;
+            }
+          return dev;
+        }
+
+      int fd = ::open (host_path (path).c_str (), oflag, 0666);
+      if (fd < 0)
+        {
+          return nullptr;
+        }
+
+      return new file
+        { fd };
+    }
+
+    // ========================================================================
+
+    io::io (io_impl& impl, type t) :
+        type_
+          { static_cast<type_t> (t) }, //
+        impl_
+          { impl }
+    {
+    }
+
+    io::~io () noexcept
+    {
+    }
+
+    int
+    io::close (void)
+    {
+      return impl_.do_close ();
+    }
+
+    ssize_t
+    io::read (void* buf, std::size_t nbyte)
+    {
+      return impl_.do_read (buf, nbyte);
+    }
+
+    ssize_t
+    io::write (const void* buf, std::size_t nbyte)
+    {
+      return impl_.do_write (buf, nbyte);
+    }
+
+    off_t
+    io::lseek (off_t offset, int whence)
+    {
+      return impl_.do_lseek (offset, whence);
+    }
+
+    int
+    io::fstat (struct stat* buf)
+    {
+      return impl_.do_fstat (buf);
+    }
+
+    // ------------------------------------------------------------------------
+
+    io_impl::~io_impl ()
+    {
+    }
+
+    int
+    io_impl::do_vopen (const char* path, int oflag, std::va_list args)
+    {
+      (void) path;
+      (void) oflag;
+      (void) args;
+      return 0;
+    }
+
+    off_t
+    io_impl::do_lseek (off_t offset, int whence)
+    {
+      (void) offset;
+      (void) whence;
+      errno = ESPIPE;
+      return -1;
+    }
+
+    int
+    io_impl::do_fstat (struct stat* buf)
+    {
+      (void) buf;
+      errno = ENOSYS;
+      return -1;
+    }
+
+    int
+    io_impl::do_close (void)
+    {
+      return 0;
+    }
+
+    // ========================================================================
+
+    tty* tty::first_ = nullptr;
+
+    tty::tty (tty_impl& impl, const char* name) :
+        io
+          { impl, type::char_device }, //
+        name_
+          { name }
+    {
+      rtos::scheduler::critical_section scs;
+
+      next_ = first_;
+      first_ = this;
+    }
+
+    tty::~tty () noexcept
+    {
+      rtos::scheduler::critical_section scs;
+
+      for (tty** pp = &first_; *pp != nullptr; pp = &(*pp)->next_)
+        {
+          if (*pp == this)
+            {
+              *pp = next_;
+              break;
+            }
+        }
+    }
+
+    tty*
+    tty::identify_device (const char* name)
+    {
+      rtos::scheduler::critical_section scs;
+
+      for (tty* p = first_; p != nullptr; p = p->next_)
+        {
+          if (strcmp (p->name_, name) == 0)
+            {
+              return p;
+            }
+        }
+
+      return nullptr;
+    }
+
+    // ========================================================================
+
+    directory::directory (DIR* dir) :
+        dir_
+          { dir }
+    {
+    }
+
+    directory::~directory ()
+    {
+    }
+
+    struct dirent*
+    directory::read (void)
+    {
+      struct dirent* dp;
+
+      // like FatFS, no entries for the directory itself and its parent
+      while ((dp = ::readdir (dir_)) != nullptr
+          && (strcmp (dp->d_name, ".") == 0 || strcmp (dp->d_name, "..") == 0))
+        {
+          ;
+        }
+
+      return dp;
+    }
+
+    int
+    directory::close (void)
+    {
+      int result = ::closedir (dir_);
+
+      delete this;
+      return result;
+    }
+
+    // ------------------------------------------------------------------------
+
+    directory*
+    opendir (const char* dirname)
+    {
+      DIR* dir = ::opendir (host_path (dirname).c_str ());
+
+      if (dir == nullptr)
+        {
+          return nullptr;
+        }
+
+      return new directory
+        { dir };
+    }
+
+    int
+    stat (const char* path, struct stat* buf)
+    {
+      return ::stat (host_path (path).c_str (), buf);
+    }
+
+    int
+    mkdir (const char* path, mode_t mode)
+    {
+      return ::mkdir (host_path (path).c_str (), mode ? mode : 0777);
+    }
+
+    int
+    rmdir (const char* path)
+    {
+      return ::rmdir (host_path (path).c_str ());
+    }
+
+    int
+    unlink (const char* path)
+    {
+      return ::unlink (host_path (path).c_str ());
+    }
+
+    int
+    rename (const char* existing, const char* _new)
+    {
+      return ::rename (host_path (existing).c_str (),
+                       host_path (_new).c_str ());
+    }
+
+    int
+    statvfs (const char* path, struct statvfs* buf)
+    {
+      return ::statvfs (host_path (path).c_str (), buf);
+    }
+
+  } /* namespace posix */
+} /* namespace os */
@@ -0,0 +1,76 @@
+/*
+ * rtc-drv.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * A stand-in for the RTC driver used by the date command.
+ */
+
+#ifndef RTC_DRV_H_
+#define RTC_DRV_H_
+
+#include <ctime>
+
+#if defined (__cplusplus)
+
+// The host clock cannot be set or calibrated; the calls succeed and change
+// nothing.
+class rtc
+{
+public:
+
+  enum
+  {
+    ok = 0
+  };
+
+  int
+  get_cal_factor (void)
+  {
+    return cal_;
+  }
+
+  void
+  set_cal_factor (long cal)
+  {
+    cal_ = static_cast<int> (cal);
+  }
+
+  int
+  set_time (time_t* t)
+  {
+    (void) t;
+    return ok;
+  }
+
+private:
+
+  int cal_ = 0;
+};
+
+#endif /* __cplusplus */
+
+#endif /* RTC_DRV_H_ */
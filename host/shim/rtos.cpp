@@ -0,0 +1,469 @@
+/*
+ * rtos.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * The parts of the µOS++ RTOS API the shell uses, over POSIX threads.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <sched.h>
+
+namespace
+{
+  pthread_mutex_t cs_mx = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+  /**
+   * @brief Return the monotonic time, in nanoseconds.
+   */
+  uint64_t
+  mono_ns (void)
+  {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t> (ts.tv_sec) * 1000000000u + ts.tv_nsec;
+  }
+
+  const uint64_t start_ns = mono_ns ();
+
+  /**
+   * @brief Return the absolute monotonic time a number of ticks from now.
+   */
+  struct timespec
+  deadline (os::rtos::clock::duration_t ticks)
+  {
+    struct timespec ts;
+    uint64_t ns;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    ns = static_cast<uint64_t> (ts.tv_nsec)
+        + static_cast<uint64_t> (ticks) * 1000000000u
+            / os::rtos::clock_systick::frequency_hz;
+    ts.tv_sec += ns / 1000000000u;
+    ts.tv_nsec = ns % 1000000000u;
+
+    return ts;
+  }
+}
+
+namespace os
+{
+  namespace rtos
+  {
+    clock_systick sysclock;
+    clock_rtc rtclock;
+
+    // ========================================================================
+
+    clock::timestamp_t
+    clock::now (void)
+    {
+      return steady_now () + offset_;
+    }
+
+    clock::timestamp_t
+    clock::steady_now (void)
+    {
+      return (mono_ns () - start_ns) / (1000000000u / hz ());
+    }
+
+    result_t
+    clock::sleep_for (duration_t duration)
+    {
+      struct timespec ts;
+      uint64_t ns = static_cast<uint64_t> (duration) * (1000000000u / hz ());
+
+      ts.tv_sec = ns / 1000000000u;
+      ts.tv_nsec = ns % 1000000000u;
+      while (nanosleep (&ts, &ts) < 0 && errno == EINTR)
+        {
+          ;
+        }
+
+      return ETIMEDOUT;
+    }
+
+    clock::offset_t
+    clock::offset (offset_t offset)
+    {
+      offset_t old = offset_;
+
+      offset_ = offset;
+      return old;
+    }
+
+    clock::offset_t
+    clock::offset (void)
+    {
+      return offset_;
+    }
+
+    uint32_t
+    clock_systick::hz (void) const
+    {
+      return frequency_hz;
+    }
+
+    clock_rtc::clock_rtc (void)
+    {
+      offset_ = time (nullptr);
+    }
+
+    uint32_t
+    clock_rtc::hz (void) const
+    {
+      return frequency_hz;
+    }
+
+    // ========================================================================
+
+    const mutex::attributes mutex::initializer_normal
+      { };
+
+    const mutex::attributes mutex::initializer_recursive
+      { true };
+
+    mutex::mutex (const attributes& attr) :
+        mutex
+          { nullptr, attr }
+    {
+    }
+
+    mutex::mutex (const char* name, const attributes& attr)
+    {
+      pthread_mutexattr_t ma;
+
+      (void) name;
+      pthread_mutexattr_init (&ma);
+      pthread_mutexattr_settype (
+          &ma,
+          attr.mx_recursive ? PTHREAD_MUTEX_RECURSIVE : PTHREAD_MUTEX_NORMAL);
+      pthread_mutex_init (&mx_, &ma);
+      pthread_mutexattr_destroy (&ma);
+    }
+
+    mutex::~mutex ()
+    {
+      pthread_mutex_destroy (&mx_);
+    }
+
+    result_t
+    mutex::lock (void)
+    {
+      return pthread_mutex_lock (&mx_);
+    }
+
+    result_t
+    mutex::try_lock (void)
+    {
+      return pthread_mutex_trylock (&mx_) == 0 ? result::ok : EWOULDBLOCK;
+    }
+
+    result_t
+    mutex::unlock (void)
+    {
+      return pthread_mutex_unlock (&mx_);
+    }
+
+    // ========================================================================
+
+    semaphore_binary::semaphore_binary (const char* name,
+                                        uint32_t initial_value) :
+        count_
+          { initial_value != 0 }
+    {
+      pthread_condattr_t ca;
+
+      (void) name;
+      pthread_mutex_init (&mx_, nullptr);
+      pthread_condattr_init (&ca);
+      pthread_condattr_setclock (&ca, CLOCK_MONOTONIC);
+      pthread_cond_init (&cv_, &ca);
+      pthread_condattr_destroy (&ca);
+    }
+
+    semaphore_binary::~semaphore_binary ()
+    {
+      pthread_cond_destroy (&cv_);
+      pthread_mutex_destroy (&mx_);
+    }
+
+    result_t
+    semaphore_binary::post (void)
+    {
+      pthread_mutex_lock (&mx_);
+      count_ = true;
+      pthread_cond_signal (&cv_);
+      pthread_mutex_unlock (&mx_);
+
+      return result::ok;
+    }
+
+    result_t
+    semaphore_binary::wait (void)
+    {
+      pthread_mutex_lock (&mx_);
+      while (!count_)
+        {
+          pthread_cond_wait (&cv_, &mx_);
+        }
+      count_ = false;
+      pthread_mutex_unlock (&mx_);
+
+      return result::ok;
+    }
+
+    result_t
+    semaphore_binary::try_wait (void)
+    {
+      result_t res = EWOULDBLOCK;
+
+      pthread_mutex_lock (&mx_);
+      if (count_)
+        {
+          count_ = false;
+          res = result::ok;
+        }
+      pthread_mutex_unlock (&mx_);
+
+      return res;
+    }
+
+    result_t
+    semaphore_binary::timed_wait (clock::duration_t timeout)
+    {
+      struct timespec ts = deadline (timeout);
+      result_t res = result::ok;
+
+      pthread_mutex_lock (&mx_);
+      while (!count_ && res == result::ok)
+        {
+          if (pthread_cond_timedwait (&cv_, &mx_, &ts) == ETIMEDOUT)
+            {
+              res = ETIMEDOUT;
+            }
+        }
+      if (count_)
+        {
+          count_ = false;
+          res = result::ok;
+        }
+      pthread_mutex_unlock (&mx_);
+
+      return res;
+    }
+
+    // ========================================================================
+
+    const thread::attributes thread::initializer
+      { };
+
+    thread::thread (const char* name, func_t function, func_args_t args,
+                    const attributes& attr) :
+        name_
+          { name }
+    {
+      stack_.size_ = attr.th_stack_size_bytes;
+      joinable_ = (pthread_create (&th_, nullptr, function, args) == 0);
+    }
+
+    thread::~thread ()
+    {
+      if (joinable_)
+        {
+          pthread_detach (th_);
+        }
+    }
+
+    result_t
+    thread::join (void** exit_ptr)
+    {
+      if (!joinable_)
+        {
+          return EINVAL;
+        }
+      joinable_ = false;
+
+      return pthread_join (th_, exit_ptr);
+    }
+
+    const char*
+    thread::name (void) const
+    {
+      return name_;
+    }
+
+    thread::state_t
+    thread::state (void) const
+    {
+      return joinable_ ? 2 : 4; // running or terminated
+    }
+
+    thread::priority_t
+    thread::priority (void)
+    {
+      return 0;
+    }
+
+    class thread::stack&
+    thread::stack (void)
+    {
+      return stack_;
+    }
+
+    class thread::statistics&
+    thread::statistics (void)
+    {
+      return statistics_;
+    }
+
+    std::size_t
+    thread::stack::size (void)
+    {
+      return size_;
+    }
+
+    std::size_t
+    thread::stack::available (void)
+    {
+      return size_;
+    }
+
+    uint64_t
+    thread::statistics::cpu_cycles (void)
+    {
+      return 0;
+    }
+
+    // ========================================================================
+
+    namespace scheduler
+    {
+      critical_section::critical_section (void)
+      {
+        pthread_mutex_lock (&cs_mx);
+      }
+
+      critical_section::~critical_section ()
+      {
+        pthread_mutex_unlock (&cs_mx);
+      }
+
+      thread*
+      threads_list::begin (void)
+      {
+        return nullptr;
+      }
+
+      thread*
+      threads_list::end (void)
+      {
+        return nullptr;
+      }
+
+      threads_list&
+      children_threads (thread* th)
+      {
+        static threads_list none;
+
+        (void) th;
+        return none;
+      }
+
+      namespace statistics
+      {
+        uint64_t
+        cpu_cycles (void)
+        {
+          return 1;
+        }
+      }
+    }
+
+    namespace this_thread
+    {
+      void
+      yield (void)
+      {
+        sched_yield ();
+      }
+    }
+
+    namespace memory
+    {
+      std::size_t
+      memory_resource::total_bytes (void)
+      {
+        return 0;
+      }
+
+      std::size_t
+      memory_resource::free_bytes (void)
+      {
+        return 0;
+      }
+
+      static memory_resource host_resource;
+      memory_resource* default_resource = &host_resource;
+    }
+
+  } /* namespace rtos */
+
+  // ==========================================================================
+
+  namespace trace
+  {
+    int
+    vprintf (const char* format, std::va_list args)
+    {
+      static const bool on = (getenv ("USHELL_TRACE") != nullptr);
+
+      return on ? vfprintf (stderr, format, args) : 0;
+    }
+
+    int
+    printf (const char* format, ...)
+    {
+      std::va_list ap;
+      int result;
+
+      va_start(ap, format);
+      result = vprintf (format, ap);
+      va_end(ap);
+
+      return result;
+    }
+
+    int
+    puts (const char* s)
+    {
+      return printf ("%s\n", s);
+    }
+  }
+} /* namespace os */
@@ -0,0 +1,231 @@
+/*
+ * cmds-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <thread>
+
+#include <cmsis-plus/posix-io/chan-fatfs-file-system.h>
+
+#include "ushell.h"
+#include "readline.h"
+#include "rtc-drv.h"
+#include "tty-pair.h"
+#include "test.h"
+
+using ushell::ushell_cmd;
+using ushell::read_line;
+
+// Built with the commands, run through a session like on a terminal.
+
+// expected by the file and built-in commands, see main.cpp
+os::posix::chan_fatfs_file_system_lockable<os::rtos::mutex> fat_fs
+  { "fat" };
+rtc my_rtc;
+
+namespace
+{
+  char history[256];
+
+  std::string
+  digits (std::size_t len)
+  {
+    std::string s;
+    for (std::size_t i = 0; i < len; i++)
+      {
+        s += static_cast<char> ('0' + i % 10);
+      }
+    return s;
+  }
+
+  // lines longer than the commands' line buffers; the needle is split
+  // between the first two pieces they are read in
+  std::string
+  needle_line (void)
+  {
+    return digits (SHELL_MAX_LINE_LEN - 4) + "needle" + digits (300);
+  }
+
+  std::string
+  plain_line (void)
+  {
+    return digits (2 * SHELL_MAX_LINE_LEN);
+  }
+
+  class ush_lines : public ushell_cmd
+  {
+  public:
+
+    ush_lines (void)
+    {
+      info_.command = "lines";
+      info_.help_text = "Print long lines";
+    }
+
+    virtual
+    ~ush_lines () noexcept
+    {
+      ushell::ushell::unlink_cmd (this);
+    }
+
+    virtual int
+    do_cmd (ushell::ushell* ush, int, char*[])
+    {
+      ush->printf ("%s\n", needle_line ().c_str ());
+      ush->printf ("short needle\n");
+      ush->printf ("%s\n", plain_line ().c_str ());
+      ush->printf ("last\n");
+      return ushell::ush_ok;
+    }
+  };
+
+  class ush_done : public ushell_cmd
+  {
+  public:
+
+    ush_done (void)
+    {
+      info_.command = "done";
+      info_.help_text = "Mark the end of the output";
+    }
+
+    virtual
+    ~ush_done () noexcept
+    {
+      ushell::ushell::unlink_cmd (this);
+    }
+
+    virtual int
+    do_cmd (ushell::ushell* ush, int, char*[])
+    {
+      ush->printf ("<done>\n");
+      return ushell::ush_ok;
+    }
+  };
+
+  // moves to a directory whose path leaves little room
+  class ush_deep : public ushell_cmd
+  {
+  public:
+
+    ush_deep (void)
+    {
+      info_.command = "deep";
+      info_.help_text = "Change to a deep directory";
+    }
+
+    virtual
+    ~ush_deep () noexcept
+    {
+      ushell::ushell::unlink_cmd (this);
+    }
+
+    virtual int
+    do_cmd (ushell::ushell* ush, int, char*[])
+    {
+      std::string dir = "/flash/" + digits (250);
+      ush->ph.to_absolute (dir.c_str (), nullptr, 0);
+      return ushell::ush_ok;
+    }
+  };
+
+  ush_lines lines;
+  ush_deep deep;
+  ush_done done;
+
+  // the output of command lines, without carriage returns
+  std::string
+  run (const char* cmd)
+  {
+    tty_pair t
+      { "cmds" };
+    read_line rl
+      { nullptr, history, sizeof(history) };
+    ushell::ushell sh
+      { "/dev/cmds", &rl };
+
+    t.send (cmd);
+    t.send ("\rdone\r");
+    std::thread session
+      { [&sh]
+        {
+          sh.do_ushell (nullptr);
+        } };
+    std::string out = t.receive_until ("<done>", 2000);
+    t.hang_up ();
+    session.join ();
+
+    std::string s;
+    for (char c : out)
+      {
+        if (c != '\r')
+          {
+            s += c;
+          }
+      }
+    return s;
+  }
+}
+
+TEST(grep_matches_across_the_pieces_of_a_long_line)
+{
+  std::string out = run ("lines | grep -c needle");
+  CHECK(out.find ("\n2\n") != std::string::npos);
+
+  out = run ("lines | grep -vc needle");
+  CHECK(out.find ("\n2\n") != std::string::npos);
+}
+
+TEST(grep_prints_a_long_line_whole)
+{
+  std::string out = run ("lines | grep 0123");
+  CHECK(out.find ("\n" + needle_line () + "\n") != std::string::npos);
+  CHECK(out.find ("\n" + plain_line () + "\n") != std::string::npos);
+  CHECK(out.find ("short") == std::string::npos);
+}
+
+TEST(head_counts_a_long_line_once)
+{
+  std::string out = run ("lines | head -n 2");
+  CHECK(
+      out.find ("\n" + needle_line () + "\nshort needle\n")
+          != std::string::npos);
+  CHECK(out.find (plain_line () + "\n") == std::string::npos);
+}
+
+TEST(a_redirection_to_a_path_too_long_is_refused)
+{
+  std::string out = run ("deep\rlines > out.txt");
+  CHECK(out.find ("Path too long") != std::string::npos);
+  CHECK(out.find ("short needle") == std::string::npos);
+}
+
+int
+main (void)
+{
+  return test::run_tests ();
+}
@@ -0,0 +1,381 @@
+/*
+ * history-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <new>
+
+#include <cmsis-plus/posix-io/file-system.h>
+
+#include "readline.h"
+#include "tty-pair.h"
+#include "test.h"
+
+using ushell::read_line;
+
+// allocations that must not throw fail while this is set
+static bool no_memory = false;
+
+void*
+operator new[] (std::size_t size, const std::nothrow_t&) noexcept
+{
+  if (no_memory)
+    {
+      return nullptr;
+    }
+  try
+    {
+      return ::operator new[] (size);
+    }
+  catch (...)
+    {
+      return nullptr;
+    }
+}
+
+namespace
+{
+  std::string
+  edit (tty_pair& t, read_line& rl, const char* input)
+  {
+    char buf[SHELL_MAX_LINE_LEN];
+
+    t.send (input);
+    int n = rl.readline ("> ", buf, sizeof(buf));
+    t.receive ();
+    return n < 0 ? "<error>" : buf;
+  }
+
+  // the entries in a history log, oldest first; each one is recalled
+  // over a copy of the log, which entering the line would change
+  std::string
+  recall_all (tty_pair& t, const char* history, std::size_t len)
+  {
+    std::string all;
+    std::string prev;
+    std::string keys;
+
+    for (int steps = 1; steps < 64; steps++)
+      {
+        char copy[256];
+        memcpy (copy, history, len);
+        read_line rl
+          { nullptr, copy, len };
+        rl.initialise (&t.tty ());
+        t.receive ();
+
+        keys += "\020";
+        std::string line = edit (t, rl, (keys + "\r").c_str ());
+        if (line.empty () || line == prev)
+          {
+            break; // empty, or stuck at the oldest
+          }
+        all = line + (all.empty () ? "" : "|") + all;
+        prev = line;
+      }
+    return all;
+  }
+
+  std::string dir;
+
+  std::string
+  file_path (const char* name)
+  {
+    return dir + name;
+  }
+
+  // the entries in a journal file, oldest first
+  std::string
+  journal (const char* name)
+  {
+    std::string all;
+    FILE* f = fopen (file_path (name).c_str (), "rb");
+    if (f == nullptr)
+      {
+        return "<none>";
+      }
+    if (fgetc (f) != 0x5A || fgetc (f) != 1)
+      {
+        fclose (f);
+        return "<bad header>";
+      }
+    uint16_t hdr[2];
+    char text[SHELL_MAX_LINE_LEN];
+    while (fread (hdr, sizeof(hdr), 1, f) == 1 && hdr[0] <= sizeof(text)
+        && fread (text, hdr[0], 1, f) == 1)
+      {
+        all += (all.empty () ? "" : "|") + std::string (text);
+      }
+    fclose (f);
+    return all;
+  }
+
+  off_t
+  file_size (const char* name)
+  {
+    struct stat st;
+    return ::stat (file_path (name).c_str (), &st) == 0 ? st.st_size : -1;
+  }
+}
+
+TEST(log_survives_a_new_session)
+{
+  char history[256] =
+    { };
+  tty_pair t;
+  t.raw ();
+  {
+    read_line rl
+      { nullptr, history, sizeof(history) };
+    rl.initialise (&t.tty ());
+    edit (t, rl, "one\r");
+    edit (t, rl, "two\r");
+    edit (t, rl, "three\r");
+  }
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+  CHECK_STR(edit (t, rl, "\020\r"), "three");
+  CHECK_STR(edit (t, rl, "\020\020\020\r"), "one");
+}
+
+TEST(log_evicts_the_oldest_when_full)
+{
+  char history[64] =
+    { };
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  for (int i = 0; i < 20; i++)
+    {
+      char line[16];
+      snprintf (line, sizeof(line), "entry-%02d\r", i);
+      edit (t, rl, line);
+    }
+  // 54 bytes of records of 15 bytes: the last three fit
+  CHECK_STR(recall_all (t, history, sizeof(history)),
+            "entry-17|entry-18|entry-19");
+}
+
+TEST(a_damaged_record_costs_only_it_and_older)
+{
+  char history[256] =
+    { };
+  tty_pair t;
+  t.raw ();
+  {
+    read_line rl
+      { nullptr, history, sizeof(history) };
+    rl.initialise (&t.tty ());
+    edit (t, rl, "one\r");
+    edit (t, rl, "two\r");
+    edit (t, rl, "three\r");
+    edit (t, rl, "four\r");
+  }
+  char* p = (char*) memmem (history, sizeof(history), "two", 4);
+  CHECK(p != nullptr);
+  p[1] = 'X';
+
+  CHECK_STR(recall_all (t, history, sizeof(history)), "three|four");
+}
+
+TEST(a_damaged_log_header_resets_the_history)
+{
+  char history[256] =
+    { };
+  tty_pair t;
+  t.raw ();
+  {
+    read_line rl
+      { nullptr, history, sizeof(history) };
+    rl.initialise (&t.tty ());
+    edit (t, rl, "one\r");
+  }
+  history[2] ^= 1;
+
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+  CHECK_STR(edit (t, rl, "\020\r"), "");
+}
+
+TEST(no_memory_for_the_history_leaves_it_out)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, "/nomem" };
+  no_memory = true;
+  rl.initialise (&t.tty ());
+  no_memory = false;
+
+  // lines are edited, not kept, and nothing is written
+  CHECK_STR(edit (t, rl, "one\r"), "one");
+  CHECK_STR(edit (t, rl, "\020\r"), "");
+  rl.end ();
+  CHECK_STR(journal ("/nomem"), "<none>");
+
+  // the next session goes on without it
+  rl.initialise (&t.tty ());
+  CHECK_STR(edit (t, rl, "\020\r"), "");
+  rl.end ();
+}
+
+TEST(journal_is_replayed)
+{
+  tty_pair t;
+  t.raw ();
+  {
+    read_line rl
+      { nullptr, "/hist" };
+    rl.initialise (&t.tty ());
+    edit (t, rl, "one\r");
+    edit (t, rl, "two\r");
+    rl.end ();
+  }
+  CHECK_STR(journal ("/hist"), "one|two");
+
+  read_line rl
+    { nullptr, "/hist" };
+  rl.initialise (&t.tty ());
+  CHECK_STR(edit (t, rl, "\020\020\r"), "one");
+  rl.end ();
+  CHECK_STR(journal ("/hist"), "one|two|one");
+}
+
+TEST(a_torn_last_entry_is_dropped)
+{
+  tty_pair t;
+  t.raw ();
+  {
+    read_line rl
+      { nullptr, "/torn" };
+    rl.initialise (&t.tty ());
+    edit (t, rl, "one\r");
+    edit (t, rl, "two\r");
+    edit (t, rl, "three\r");
+    rl.end ();
+  }
+  CHECK_INT(truncate (file_path ("/torn").c_str (), file_size ("/torn") - 2),
+            0);
+
+  // the journal is rewritten without it
+  read_line rl
+    { nullptr, "/torn" };
+  rl.initialise (&t.tty ());
+  CHECK_STR(journal ("/torn"), "one|two");
+  CHECK_STR(edit (t, rl, "\020\r"), "two");
+}
+
+TEST(journal_is_compacted_when_too_big)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, "/big" };
+  rl.initialise (&t.tty ());
+
+  for (int i = 0; i < 400; i++)
+    {
+      char line[32];
+      snprintf (line, sizeof(line), "a longer history entry %03d\r", i);
+      edit (t, rl, line);
+      CHECK(file_size ("/big") <= SHELL_HISTORY_JOURNAL_LEN);
+    }
+  rl.end ();
+  CHECK(file_size ("/big") <= SHELL_HISTORY_JOURNAL_LEN);
+
+  read_line again
+    { nullptr, "/big" };
+  again.initialise (&t.tty ());
+  CHECK_STR(edit (t, again, "\020\r"), "a longer history entry 399");
+}
+
+TEST(a_journal_gone_is_written_anew)
+{
+  tty_pair t;
+  t.raw ();
+  {
+    read_line rl
+      { nullptr, "/gone" };
+    rl.initialise (&t.tty ());
+    edit (t, rl, "one\r");
+    rl.end ();
+  }
+
+  read_line rl
+    { nullptr, "/gone" };
+  rl.initialise (&t.tty ());
+  CHECK_INT(unlink (file_path ("/gone").c_str ()), 0);
+  edit (t, rl, "two\r");
+  rl.end ();
+  // with its header, and what was replayed
+  CHECK_STR(journal ("/gone"), "one|two");
+}
+
+TEST(entries_survive_a_failed_compaction)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, "/stuck" };
+  rl.initialise (&t.tty ());
+
+  // no journal to append to, and none can be written
+  CHECK_INT(unlink (file_path ("/stuck").c_str ()), 0);
+  CHECK_INT(mkdir (file_path ("/stuck~").c_str (), 0700), 0);
+  edit (t, rl, "one\r");
+  rl.end ();
+  CHECK_STR(journal ("/stuck"), "<none>");
+
+  CHECK_INT(rmdir (file_path ("/stuck~").c_str ()), 0);
+  edit (t, rl, "two\r");
+  rl.end ();
+  CHECK_STR(journal ("/stuck"), "one|two");
+}
+
+int
+main (void)
+{
+  char tmp[] = "/tmp/ushell-history-XXXXXX";
+  if (mkdtemp (tmp) == nullptr)
+    {
+      return 1;
+    }
+  dir = tmp;
+  os::posix::host_root (tmp);
+
+  int result = test::run_tests ();
+
+  system (("rm -rf " + dir).c_str ());
+  return result;
+}
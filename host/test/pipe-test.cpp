@@ -0,0 +1,130 @@
+/*
+ * pipe-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <thread>
+
+#include "ushell.h"
+#include "test.h"
+
+using ushell::ring_pipe;
+
+TEST(passes_data_in_order)
+{
+  ring_pipe p
+    { 16 };
+  char buf[16];
+
+  CHECK(p.valid ());
+  CHECK_INT(p.write ("hello", 5), 5);
+  CHECK_INT(p.read (buf, 3), 3);
+  CHECK(memcmp (buf, "hel", 3) == 0);
+  CHECK_INT(p.read (buf, sizeof(buf)), 2);
+  CHECK(memcmp (buf, "lo", 2) == 0);
+}
+
+TEST(end_of_file_after_the_data)
+{
+  ring_pipe p
+    { 16 };
+  char buf[16];
+
+  p.write ("abc", 3);
+  p.close_write ();
+  CHECK_INT(p.read (buf, sizeof(buf)), 3);
+  CHECK_INT(p.read (buf, sizeof(buf)), 0);
+  CHECK_INT(p.read (buf, sizeof(buf)), 0);
+}
+
+TEST(writes_fail_once_the_reader_is_gone)
+{
+  ring_pipe p
+    { 16 };
+
+  p.close_read ();
+  CHECK_INT(p.write ("abc", 3), -1);
+}
+
+TEST(writer_blocks_until_read_and_wraps)
+{
+  // not a power of two, rounded up to 128
+  ring_pipe p
+    { 100 };
+  std::string got;
+
+  std::thread reader
+    { [&]
+      {
+        char buf[37];
+        ssize_t n;
+        while ((n = p.read (buf, sizeof(buf))) > 0)
+          {
+            got.append (buf, n);
+          }
+      } };
+
+  std::string sent;
+  for (int i = 0; i < 2000; i++)
+    {
+      char line[16];
+      int n = snprintf (line, sizeof(line), "%d,", i);
+      sent.append (line, n);
+      CHECK_INT(p.write (line, n), n);
+    }
+  p.close_write ();
+  reader.join ();
+
+  CHECK(got == sent);
+}
+
+TEST(reader_closing_unblocks_a_full_writer)
+{
+  ring_pipe p
+    { 8 };
+  ssize_t result = 0;
+
+  std::thread writer
+    { [&]
+      {
+        char big[64] =
+          { };
+        result = p.write (big, sizeof(big));
+      } };
+
+  char buf[4];
+  CHECK_INT(p.read (buf, sizeof(buf)), 4);
+  p.close_read ();
+  writer.join ();
+  CHECK_INT(result, -1);
+}
+
+int
+main (void)
+{
+  return test::run_tests ();
+}
@@ -0,0 +1,280 @@
+/*
+ * readline-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <thread>
+#include <chrono>
+
+#include "readline.h"
+#include "tty-pair.h"
+#include "test.h"
+
+using ushell::read_line;
+
+namespace
+{
+  char history[256];
+
+  // feed the input to a fresh line, return what readline returned
+  std::string
+  edit (tty_pair& t, read_line& rl, const char* input)
+  {
+    char buf[SHELL_MAX_LINE_LEN];
+
+    t.send (input);
+    int n = rl.readline ("> ", buf, sizeof(buf));
+    t.receive ();
+    return n < 0 ? "<error>" : buf;
+  }
+}
+
+TEST(plain_line)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  CHECK_STR(edit (t, rl, "hello world\r"), "hello world");
+  CHECK_STR(edit (t, rl, "\n"), "");
+}
+
+TEST(cursor_keys_and_insertion)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  // left arrow twice, insert; home, insert; end, insert
+  CHECK_STR(edit (t, rl, "acd\033[D\033[Db\001>\005<\r"), ">abcd<");
+  // ctrl-b / ctrl-f, and the SS3 forms of home and end
+  CHECK_STR(edit (t, rl, "xz\002y\006!\033OH^\033OF$\r"), "^xyz!$");
+}
+
+TEST(deleting)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  // backspace (DEL and ctrl-h), delete under the cursor
+  CHECK_STR(edit (t, rl, "abcx\x7F" "d\010\001\033[3~\r"), "bc");
+  // ctrl-w removes the word before the cursor, ctrl-k to the end,
+  // ctrl-u to the start
+  CHECK_STR(edit (t, rl, "one two\027\r"), "one ");
+  CHECK_STR(edit (t, rl, "one two\001\006\006\006\013\r"), "one");
+  CHECK_STR(edit (t, rl, "one two\002\002\002\025\r"), "two");
+}
+
+TEST(words)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  CHECK_STR(edit (t, rl, "aa bb cc\033b\033b|\r"), "aa |bb cc");
+  // forward to the start of the next word
+  CHECK_STR(edit (t, rl, "aa bb cc\001\033f|\r"), "aa |bb cc");
+  CHECK_STR(edit (t, rl, "aa bb cc\033[1;5D\033[1;5D\033d\r"), "aa cc");
+}
+
+TEST(unknown_sequences_are_swallowed)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  CHECK_STR(edit (t, rl, "a\033[Zb\033[15~c\r"), "abc");
+}
+
+TEST(lone_escape_is_dropped_after_a_pause)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  std::thread later
+    { [&]
+      {
+        std::this_thread::sleep_for (
+            std::chrono::milliseconds (3 * SHELL_ESC_TIMEOUT));
+        t.send ("[Dc\r");
+      } };
+  std::string line = edit (t, rl, "ab\033");
+  later.join ();
+
+  // "[D" is text once the ESC timed out
+  CHECK_STR(line, "ab[Dc");
+}
+
+TEST(ctrl_c_drops_the_line)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  CHECK_STR(edit (t, rl, "abc\003de\r"), "de");
+}
+
+TEST(ctrl_c_taken_by_the_tty_drops_the_line)
+{
+  tty_pair t;
+  t.raw ();
+  struct termios tio;
+  t.tty ().tcgetattr (&tio);
+  tio.c_lflag |= ISIG;
+  tio.c_cc[VINTR] = 3;
+  t.tty ().tcsetattr (TCSANOW, &tio);
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  std::thread later
+    { [&]
+      {
+        std::this_thread::sleep_for (std::chrono::milliseconds (20));
+        t.send ("\003");
+        std::this_thread::sleep_for (std::chrono::milliseconds (20));
+        t.send ("de\r");
+      } };
+  CHECK_STR(edit (t, rl, "abc"), "de");
+  later.join ();
+  CHECK(!t.tty ().clear_interrupt ());
+}
+
+TEST(utf8_glyphs_are_edited_whole)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  CHECK_STR(edit (t, rl, "a\xC3\xA9\xE2\x82\xAC" "b\002\002\x7F\r"),
+            "a\xE2\x82\xAC" "b");
+}
+
+TEST(bracketed_paste_runs_over_lines)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+  t.receive ();
+
+  // tabs become spaces, other control characters are dropped, CR LF ends
+  // one line, the rest is kept for the next call
+  t.send ("\033[200~one\ttwo\r\nthr\033ee\n\033[201~");
+  char buf[SHELL_MAX_LINE_LEN];
+  CHECK_INT(rl.readline ("> ", buf, sizeof(buf)), 7);
+  CHECK_STR(buf, "one two");
+  CHECK_INT(rl.readline ("> ", buf, sizeof(buf)), 5);
+  CHECK_STR(buf, "three");
+}
+
+TEST(history_recall)
+{
+  tty_pair t;
+  t.raw ();
+  memset (history, 0, sizeof(history));
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  edit (t, rl, "first\r");
+  edit (t, rl, "second\r");
+  edit (t, rl, "second\r"); // a repeat is not kept
+  CHECK_STR(edit (t, rl, "\033[A\r"), "second");
+  CHECK_STR(edit (t, rl, "\033[A\033[A\r"), "first");
+  // at the oldest it stays there; down to the new line
+  CHECK_STR(edit (t, rl, "\020\020\020\020\r"), "first");
+  CHECK_STR(edit (t, rl, "new\020\016\r"), "");
+  CHECK_STR(edit (t, rl, "\033<\r"), "first");
+}
+
+TEST(a_driver_without_rx_wait_times_its_own_reads)
+{
+  tty_pair t
+    { "untimed", false };
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  // the lone ESC is timed by the driver, with VTIME
+  std::thread later
+    { [&]
+      {
+        std::this_thread::sleep_for (
+            std::chrono::milliseconds (3 * SHELL_ESC_TIMEOUT));
+        t.send ("[Dc\r");
+      } };
+  std::string line = edit (t, rl, "ab\033");
+  later.join ();
+  CHECK_STR(line, "ab[Dc");
+
+  // and then blocks again
+  struct termios tio;
+  t.impl ().do_tcgetattr (&tio);
+  CHECK_INT(tio.c_cc[VMIN], 1);
+  CHECK_INT(tio.c_cc[VTIME], 0);
+}
+
+TEST(the_tty_failing_ends_the_line)
+{
+  tty_pair t;
+  t.raw ();
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  rl.initialise (&t.tty ());
+
+  t.send ("abc");
+  t.hang_up ();
+  char buf[SHELL_MAX_LINE_LEN];
+  CHECK_INT(rl.readline ("> ", buf, sizeof(buf)), -1);
+}
+
+int
+main (void)
+{
+  return test::run_tests ();
+}
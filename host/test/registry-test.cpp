@@ -0,0 +1,276 @@
+/*
+ * registry-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <new>
+
+#include "ushell.h"
+#include "test.h"
+
+using ushell::ushell_cmd;
+using ushell::buffer_sink;
+
+namespace
+{
+  // prints its text; unlinks itself from its destructor, or leaves it to
+  // the base class
+  class ush_say : public ushell_cmd
+  {
+  public:
+
+    ush_say (const char* name, const char* text, bool unlink = true) :
+        text_
+          { text }, //
+        unlink_
+          { unlink }
+    {
+      info_.command = name;
+      info_.help_text = "Print a text";
+    }
+
+    virtual
+    ~ush_say () noexcept
+    {
+      if (unlink_)
+        {
+          ushell::ushell::unlink_cmd (this);
+        }
+    }
+
+    virtual int
+    do_cmd (ushell::ushell* ush, int, char*[])
+    {
+      ush->printf ("%s", text_);
+      return ushell::ush_ok;
+    }
+
+  private:
+
+    const char* text_;
+    bool unlink_;
+  };
+
+  // blocks until let go
+  class ush_block : public ushell_cmd
+  {
+  public:
+
+    ush_block (void)
+    {
+      info_.command = "block";
+      info_.help_text = "Wait";
+    }
+
+    virtual
+    ~ush_block () noexcept
+    {
+      ushell::ushell::unlink_cmd (this);
+    }
+
+    virtual int
+    do_cmd (ushell::ushell*, int, char*[])
+    {
+      running = true;
+      go.wait ();
+      return ushell::ush_ok;
+    }
+
+    std::atomic<bool> running
+      { false };
+    os::rtos::semaphore_binary go
+      { "go", 0 };
+  };
+
+  // reads its input to the end, unless cancelled
+  class ush_input : public ushell_cmd
+  {
+  public:
+
+    ush_input (void)
+    {
+      info_.command = "input";
+      info_.help_text = "Read the input";
+    }
+
+    virtual
+    ~ush_input () noexcept
+    {
+      ushell::ushell::unlink_cmd (this);
+    }
+
+    virtual int
+    do_cmd (ushell::ushell* ush, int, char*[])
+    {
+      char line[16];
+      int lines = 0;
+
+      while (!ush->cancelled () && ush->getline (line, sizeof(line)) >= 0)
+        {
+          lines++;
+        }
+      ush->printf ("%d lines", lines);
+      return ushell::ush_ok;
+    }
+  };
+
+  ushell::ushell sh
+    { "/dev/none" };
+  // exec () on a shell waits for the command in progress
+  ushell::ushell other
+    { "/dev/none" };
+
+  std::string
+  run (const char* line, int* result = nullptr, ushell::ushell* on = &sh)
+  {
+    char buf[64];
+    char out[64];
+    buffer_sink sink
+      { out, sizeof(out) };
+
+    strcpy (buf, line);
+    int r = on->exec (buf, &sink);
+    if (result != nullptr)
+      {
+        *result = r;
+      }
+    return out;
+  }
+}
+
+TEST(exec_on_a_shell_not_static_has_no_tty)
+{
+  ush_input input;
+
+  // whatever the memory held before, there is no session tty
+  alignas(ushell::ushell) unsigned char mem[sizeof(ushell::ushell)];
+  memset (mem, 0xA5, sizeof(mem));
+  ushell::ushell* on = new (mem) ushell::ushell
+    { "/dev/none" };
+
+  int result = -1;
+  CHECK_STR(run ("input", &result, on), "0 lines");
+  CHECK_INT(result, ushell::ush_ok);
+  on->~ushell ();
+}
+
+TEST(first_linked_wins_a_name_clash)
+{
+  ush_say a
+    { "dup", "first" };
+  ush_say b
+    { "DUP", "second" };
+  ush_say c
+    { "dup", "third" };
+
+  CHECK_STR(run ("dup"), "first");
+  ushell::ushell::unlink_cmd (&a);
+  CHECK_STR(run ("dup"), "second");
+}
+
+TEST(many_commands_in_few_buckets)
+{
+  static char names[100][8];
+  ush_say* cmds[100];
+
+  for (int i = 0; i < 100; i++)
+    {
+      snprintf (names[i], sizeof(names[i]), "c%d", i);
+      cmds[i] = new ush_say
+        { names[i], names[i] };
+    }
+  for (int i = 0; i < 100; i += 7)
+    {
+      CHECK_STR(run (names[i]), names[i]);
+    }
+  for (int i = 0; i < 100; i += 2)
+    {
+      delete cmds[i];
+    }
+  int result;
+  run ("c10", &result);
+  CHECK_INT(result, ushell::ush_cmd_not_found);
+  CHECK_STR(run ("c11"), "c11");
+  for (int i = 1; i < 100; i += 2)
+    {
+      delete cmds[i];
+    }
+}
+
+TEST(the_base_destructor_unlinks)
+{
+  ush_say* late = new ush_say
+    { "late", "here", false };
+  CHECK_STR(run ("late"), "here");
+  delete late;
+
+  int result;
+  run ("late", &result);
+  CHECK_INT(result, ushell::ush_cmd_not_found);
+}
+
+TEST(unlink_waits_for_a_running_command)
+{
+  ush_block block;
+  std::thread runner
+    { []
+      { run ("block");} };
+  while (!block.running)
+    {
+      std::this_thread::yield ();
+    }
+
+  std::atomic<bool> unlinked
+    { false };
+  std::thread unlinker
+    { [&]
+      {
+        ushell::ushell::unlink_cmd (&block);
+        unlinked = true;
+      } };
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+  CHECK(!unlinked);
+
+  // no longer found, while still running
+  int result;
+  run ("block", &result, &other);
+  CHECK_INT(result, ushell::ush_cmd_not_found);
+
+  block.go.post ();
+  runner.join ();
+  unlinker.join ();
+  CHECK(unlinked);
+}
+
+int
+main (void)
+{
+  return test::run_tests ();
+}
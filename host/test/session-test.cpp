@@ -0,0 +1,124 @@
+/*
+ * session-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <thread>
+
+#include "ushell.h"
+#include "readline.h"
+#include "tty-pair.h"
+#include "test.h"
+
+using ushell::ushell_cmd;
+using ushell::read_line;
+
+namespace
+{
+  char history[256];
+
+  // records how the session set the driver up, then prints a lot
+  class ush_probe : public ushell_cmd
+  {
+  public:
+
+    ush_probe (tty_pair& t) :
+        t_
+          { t }
+    {
+      info_.command = "probe";
+      info_.help_text = "Look at the tty";
+    }
+
+    virtual
+    ~ush_probe () noexcept
+    {
+      ushell::ushell::unlink_cmd (this);
+    }
+
+    virtual int
+    do_cmd (ushell::ushell* ush, int, char*[])
+    {
+      t_.impl ().do_tcgetattr (&tio);
+      setattr = t_.impl ().setattr_count ();
+      for (int i = 0; i < 100; i++)
+        {
+          ush->printf ("line %d\n", i);
+          ush->flush ();
+        }
+      setattr_after = t_.impl ().setattr_count ();
+      ush->printf ("probed\n");
+      return ushell::ush_ok;
+    }
+
+    struct termios tio;
+    unsigned int setattr = 0;
+    unsigned int setattr_after = 0;
+
+  private:
+
+    tty_pair& t_;
+  };
+}
+
+TEST(a_session_sets_the_driver_up_with_the_default_options)
+{
+  tty_pair t
+    { "session" };
+  ush_probe probe
+    { t };
+  read_line rl
+    { nullptr, history, sizeof(history) };
+  ushell::ushell sh
+    { "/dev/session", &rl };
+
+  t.send ("probe\r");
+  std::thread session
+    { [&sh]
+      {
+        sh.do_ushell (nullptr);
+      } };
+  std::string out = t.receive_until ("probed", 2000);
+  t.hang_up ();
+  session.join ();
+  CHECK(out.find ("probed") != std::string::npos);
+
+  // no flow control, no ctrl-c, and blocking reads
+  CHECK_INT(probe.tio.c_iflag & (IXON | IXOFF), 0);
+  CHECK_INT(probe.tio.c_lflag & ISIG, 0);
+  CHECK_INT(probe.tio.c_cc[VMIN], 1);
+  CHECK_INT(probe.tio.c_cc[VTIME], 0);
+
+  // output does not touch the driver's settings
+  CHECK_INT(probe.setattr_after, probe.setattr);
+}
+
+int
+main (void)
+{
+  return test::run_tests ();
+}
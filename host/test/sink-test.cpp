@@ -0,0 +1,181 @@
+/*
+ * sink-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <vector>
+
+#include "output-sink.h"
+#include "test.h"
+
+using ushell::buffer_sink;
+using ushell::file_sink;
+
+namespace
+{
+  // a file that records the size of each write and takes at most room bytes
+  class recording_impl : public os::posix::io_impl
+  {
+  public:
+
+    virtual ssize_t
+    do_read (void*, std::size_t)
+    {
+      return -1;
+    }
+
+    virtual ssize_t
+    do_write (const void* buf, std::size_t nbyte)
+    {
+      if (nbyte > room)
+        {
+          nbyte = room;
+        }
+      room -= nbyte;
+      writes.push_back (nbyte);
+      data.append (static_cast<const char*> (buf), nbyte);
+      return nbyte;
+    }
+
+    std::vector<std::size_t> writes;
+    std::string data;
+    std::size_t room = ~static_cast<std::size_t> (0);
+  };
+
+  class recording_file : public os::posix::io
+  {
+  public:
+
+    recording_file (void) :
+        io
+          { impl_rec, type::file }
+    {
+    }
+
+    recording_impl impl_rec;
+  };
+}
+
+TEST(buffer_sink_collects_and_terminates)
+{
+  char buf[8];
+  buffer_sink s
+    { buf, sizeof(buf) };
+
+  CHECK_INT(s.write ("abc", 3), 3);
+  CHECK_INT(s.write ("de", 2), 2);
+  CHECK_STR(s.data (), "abcde");
+  CHECK_INT(s.size (), 5);
+  CHECK(!s.overflow ());
+}
+
+TEST(buffer_sink_drops_what_does_not_fit)
+{
+  char buf[8];
+  buffer_sink s
+    { buf, sizeof(buf) };
+
+  CHECK_INT(s.write ("0123456789", 10), 7);
+  CHECK_STR(s.data (), "0123456");
+  CHECK(s.overflow ());
+  CHECK_INT(s.write ("x", 1), 0);
+
+  s.reset ();
+  CHECK_STR(s.data (), "");
+  CHECK_INT(s.size (), 0);
+  CHECK(!s.overflow ());
+}
+
+TEST(file_sink_writes_through_without_a_block)
+{
+  recording_file f;
+  file_sink s
+    { &f };
+
+  s.write ("ab", 2);
+  s.write ("cde", 3);
+  CHECK_INT(f.impl_rec.writes.size (), 2);
+  CHECK_STR(f.impl_rec.data, "abcde");
+}
+
+TEST(file_sink_writes_whole_aligned_blocks)
+{
+  recording_file f;
+  // the file already holds 5 bytes; the first write completes the block
+  file_sink s
+    { &f, 16, 5 };
+
+  for (int i = 0; i < 10; i++)
+    {
+      CHECK_INT(s.write ("0123456", 7), 7);
+    }
+  CHECK_INT(s.flush (), 0);
+  CHECK_INT(s.error (), 0);
+
+  std::vector<std::size_t> expected
+    { 11, 16, 16, 16, 11 };
+  CHECK(f.impl_rec.writes == expected);
+  CHECK_INT(f.impl_rec.data.size (), 70);
+}
+
+TEST(file_sink_writes_large_data_directly)
+{
+  recording_file f;
+  file_sink s
+    { &f, 16 };
+  std::string big (40, 'x');
+
+  s.write ("ab", 2);
+  s.write (big.data (), big.size ());
+  s.flush ();
+
+  // 14 to complete the first block, then one direct block, then the tail
+  std::vector<std::size_t> expected
+    { 16, 16, 10 };
+  CHECK(f.impl_rec.writes == expected);
+  CHECK_STR(f.impl_rec.data, "ab" + big);
+}
+
+TEST(file_sink_reports_a_full_file)
+{
+  recording_file f;
+  f.impl_rec.room = 20;
+  file_sink s
+    { &f, 16 };
+
+  CHECK_INT(s.write ("0123456789abcdef", 16), 16);
+  CHECK_INT(s.write ("0123456789", 10), 10);
+  CHECK_INT(s.flush (), -1);
+  CHECK_INT(errno, ENOSPC);
+  CHECK_INT(s.error (), ENOSPC);
+}
+
+int
+main (void)
+{
+  return test::run_tests ();
+}
@@ -0,0 +1,152 @@
+/*
+ * test.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#ifndef HOST_TEST_TEST_H_
+#define HOST_TEST_TEST_H_
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// A minimal test runner: TEST () defines and registers a test case, the
+// CHECK macros report a failure and let the test go on, run_tests () runs
+// the cases in the order they are defined and returns non-zero if any
+// failed. One test program per source file.
+
+namespace test
+{
+  typedef void
+  (*test_fn_t) (void);
+
+  struct test_case
+  {
+    const char* name;
+    test_fn_t fn;
+    test_case* next;
+  };
+
+  inline test_case*&
+  first (void)
+  {
+    static test_case* first = nullptr;
+    return first;
+  }
+
+  inline int&
+  failures (void)
+  {
+    static int failures = 0;
+    return failures;
+  }
+
+  struct registrar
+  {
+    registrar (test_case* tc)
+    {
+      test_case** pp = &first ();
+      while (*pp != nullptr)
+        {
+          pp = &(*pp)->next;
+        }
+      *pp = tc;
+    }
+  };
+
+  inline bool
+  check (bool ok, const char* what, const char* file, int line)
+  {
+    if (!ok)
+      {
+        fprintf (stderr, "%s:%d: check failed: %s\n", file, line, what);
+        failures ()++;
+      }
+    return ok;
+  }
+
+  inline bool
+  check_str (const std::string& actual, const std::string& expected,
+             const char* what, const char* file, int line)
+  {
+    if (actual != expected)
+      {
+        fprintf (stderr, "%s:%d: check failed: %s\n  actual:   \"%s\"\n"
+                 "  expected: \"%s\"\n",
+                 file, line, what, actual.c_str (), expected.c_str ());
+        failures ()++;
+        return false;
+      }
+    return true;
+  }
+
+  inline bool
+  check_int (long actual, long expected, const char* what, const char* file,
+             int line)
+  {
+    if (actual != expected)
+      {
+        fprintf (stderr, "%s:%d: check failed: %s\n  actual:   %ld\n"
+                 "  expected: %ld\n",
+                 file, line, what, actual, expected);
+        failures ()++;
+        return false;
+      }
+    return true;
+  }
+
+  inline int
+  run_tests (void)
+  {
+    for (test_case* tc = first (); tc != nullptr; tc = tc->next)
+      {
+        int before = failures ();
+        tc->fn ();
+        printf ("%-40s %s\n", tc->name, failures () == before ? "ok" : "FAILED");
+      }
+    return failures () != 0;
+  }
+}
+
+#define TEST(name) \
+  static void name (void); \
+  static test::test_case name##_case = { #name, name, nullptr }; \
+  static test::registrar name##_reg { &name##_case }; \
+  static void name (void)
+
+#define CHECK(cond) \
+  test::check ((cond), #cond, __FILE__, __LINE__)
+
+#define CHECK_STR(actual, expected) \
+  test::check_str ((actual), (expected), #actual " == " #expected, \
+                   __FILE__, __LINE__)
+
+#define CHECK_INT(actual, expected) \
+  test::check_int ((long) (actual), (long) (expected), \
+                   #actual " == " #expected, __FILE__, __LINE__)
+
+#endif /* HOST_TEST_TEST_H_ */
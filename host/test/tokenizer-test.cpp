@@ -0,0 +1,132 @@
+/*
+ * tokenizer-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include "tokenizer.h"
+#include "test.h"
+
+using ushell::tokenizer;
+
+namespace
+{
+  // split a copy of the line and join the arguments with '|'
+  std::string
+  split (const char* line, int max = 16, int* argc = nullptr)
+  {
+    char buf[256];
+    char* argv[16];
+    std::string s;
+
+    strcpy (buf, line);
+    int n = tokenizer::split (buf, argv, max);
+    for (int i = 0; i < n && i < max; i++)
+      {
+        s += (i ? "|" : "");
+        s += argv[i];
+      }
+    if (argc != nullptr)
+      {
+        *argc = n;
+      }
+    return s;
+  }
+}
+
+TEST(splits_on_blanks)
+{
+  CHECK_STR(split ("ls  -l\t/flash "), "ls|-l|/flash");
+  CHECK_STR(split ("   "), "");
+  CHECK_STR(split (""), "");
+}
+
+TEST(single_quotes_keep_everything)
+{
+  CHECK_STR(split ("echo 'a \"b\" \\c'"), "echo|a \"b\" \\c");
+}
+
+TEST(double_quotes_escape_quote_and_backslash)
+{
+  CHECK_STR(split ("echo \"a \\\"b\\\" \\\\ \\n\""), "echo|a \"b\" \\ \\n");
+}
+
+TEST(backslash_escapes_outside_quotes)
+{
+  CHECK_STR(split ("echo a\\ b c\\\\d \\'"), "echo|a b|c\\d|'");
+  // a trailing backslash is kept
+  CHECK_STR(split ("echo a\\"), "echo|a\\");
+}
+
+TEST(adjacent_parts_form_one_argument)
+{
+  CHECK_STR(split ("a\"b c\"d 'e'f"), "ab cd|ef");
+  CHECK_STR(split ("\"\" x"), "|x");
+}
+
+TEST(unterminated_quote_ends_at_end_of_line)
+{
+  CHECK_STR(split ("echo \"a b"), "echo|a b");
+}
+
+TEST(arguments_point_into_the_line)
+{
+  char buf[] = "cmd one 'two'";
+  char* argv[4];
+
+  CHECK_INT(tokenizer::split (buf, argv, 4), 3);
+  CHECK(argv[0] == buf);
+  CHECK(argv[1] == buf + 4);
+  CHECK(argv[2] >= buf && argv[2] < buf + sizeof(buf));
+  CHECK(argv[3] == nullptr);
+}
+
+TEST(too_many_arguments_are_counted_not_stored)
+{
+  int argc;
+
+  CHECK_STR(split ("a b c d e", 3, &argc), "a|b|c");
+  CHECK_INT(argc, 5);
+}
+
+TEST(find_unquoted_skips_quotes_and_escapes)
+{
+  char a[] = "echo 'a|b' \"c|d\" e\\|f | wc";
+  char* p = tokenizer::find_unquoted (a, '|');
+  CHECK(p != nullptr && p == strstr (a, "| wc"));
+
+  char b[] = "echo \"a\\\"|b\"";
+  CHECK(tokenizer::find_unquoted (b, '|') == nullptr);
+
+  char c[] = "ls > out";
+  CHECK(tokenizer::find_unquoted (c, '>') == c + 3);
+}
+
+int
+main (void)
+{
+  return test::run_tests ();
+}
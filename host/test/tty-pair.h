@@ -0,0 +1,168 @@
+/*
+ * tty-pair.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#ifndef HOST_TEST_TTY_PAIR_H_
+#define HOST_TEST_TTY_PAIR_H_
+
+#include <sys/socket.h>
+#include <poll.h>
+#include <signal.h>
+#include <string>
+
+#include "fd-tty.h"
+
+// A tty_canonical over one end of a socket pair; the test plays the
+// terminal on the other end. The tty is registered as "/dev/<name>".
+
+class tty_pair
+{
+public:
+
+  // timed: use the driver's do_rx_wait (), or time its reads with VTIME
+  // as a plain tty_impl
+  tty_pair (const char* name = "test", bool timed = true)
+  {
+    // writes after hang_up () fail with EPIPE instead
+    signal (SIGPIPE, SIG_IGN);
+    socketpair (AF_UNIX, SOCK_STREAM, 0, fds_);
+    impl_ = new os::posix::fd_tty_impl
+      { fds_[0], fds_[0] };
+    if (timed)
+      {
+        tty_ = new os::posix::tty_canonical
+          { *impl_, name };
+      }
+    else
+      {
+        tty_ = new os::posix::tty_canonical
+          { static_cast<os::posix::tty_impl&> (*impl_), name };
+      }
+  }
+
+  ~tty_pair ()
+  {
+    delete tty_;
+    delete impl_;
+    close (fds_[0]);
+    if (fds_[1] >= 0)
+      {
+        close (fds_[1]);
+      }
+  }
+
+  os::posix::tty_canonical&
+  tty (void)
+  {
+    return *tty_;
+  }
+
+  os::posix::fd_tty_impl&
+  impl (void)
+  {
+    return *impl_;
+  }
+
+  // the terminal types
+  void
+  send (const void* buf, std::size_t len)
+  {
+    ::write (fds_[1], buf, len);
+  }
+
+  void
+  send (const char* s)
+  {
+    send (s, strlen (s));
+  }
+
+  // the terminal hangs up; the tty's reads fail
+  void
+  hang_up (void)
+  {
+    close (fds_[1]);
+    fds_[1] = -1;
+  }
+
+  // what the tty sent so far, waiting at most ms for the first byte
+  std::string
+  receive (int ms = 0)
+  {
+    std::string s;
+    char buf[256];
+    struct pollfd pfd =
+      { fds_[1], POLLIN, 0 };
+
+    while (poll (&pfd, 1, s.empty () ? ms : 0) > 0)
+      {
+        ssize_t n = ::read (fds_[1], buf, sizeof(buf));
+        if (n <= 0)
+          {
+            break;
+          }
+        s.append (buf, n);
+      }
+    return s;
+  }
+
+  // what the tty sent, until it contains the given text or ms elapsed
+  std::string
+  receive_until (const char* text, int ms)
+  {
+    std::string s;
+    for (int t = 0; t < ms && s.find (text) == std::string::npos; t += 10)
+      {
+        s += receive (10);
+      }
+    return s;
+  }
+
+  // set the tty up as ushell does with readline: raw, one byte at a time
+  void
+  raw (void)
+  {
+    struct termios tio;
+    tty_->tcgetattr (&tio);
+    tio.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON | IXOFF);
+    tio.c_oflag |= (OPOST | ONLCR);
+    tio.c_cflag |= CS8;
+    tio.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tty_->tcsetattr (TCSANOW, &tio);
+  }
+
+private:
+
+  int fds_[2];
+  os::posix::fd_tty_impl* impl_;
+  os::posix::tty_canonical* tty_;
+
+};
+
+#endif /* HOST_TEST_TTY_PAIR_H_ */
@@ -0,0 +1,215 @@
+/*
+ * tty-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+#include "tty-pair.h"
+#include "test.h"
+
+namespace
+{
+  // raw, with output flow control
+  void
+  ixon (tty_pair& t)
+  {
+    t.raw ();
+    struct termios tio;
+    t.tty ().tcgetattr (&tio);
+    tio.c_iflag |= IXON;
+    t.tty ().tcsetattr (TCSANOW, &tio);
+  }
+
+  // a write from another thread
+  struct writer
+  {
+    writer (tty_pair& t, const char* s) :
+        th
+          { [&t, s, this]
+            {
+              t.tty ().write (s, strlen (s));
+              done = true;
+            } }
+    {
+    }
+
+    ~writer ()
+    {
+      th.join ();
+    }
+
+    std::atomic<bool> done
+      { false };
+    std::thread th;
+  };
+}
+
+TEST(stopped_output_waits_for_start)
+{
+  tty_pair t;
+  ixon (t);
+
+  // nobody reads: the writer finds STOP itself
+  t.send ("\023");
+  std::this_thread::sleep_for (std::chrono::milliseconds (20));
+  writer w
+    { t, "hello" };
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+  CHECK(!w.done);
+  CHECK_STR(t.receive (), "");
+
+  t.send ("\021");
+  CHECK_STR(t.receive_until ("hello", 1000), "hello");
+}
+
+TEST(stopped_output_waits_for_start_over_an_untimed_driver)
+{
+  tty_pair t
+    { "untimed", false };
+  ixon (t);
+
+  // a reader takes STOP out of the input, then the writer waits for START
+  // in the driver
+  char c;
+  t.send ("\023x");
+  CHECK_INT(t.tty ().read (&c, 1), 1);
+  writer w
+    { t, "hello" };
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+  CHECK(!w.done);
+  CHECK_STR(t.receive (), "");
+
+  t.send ("\021");
+  CHECK_STR(t.receive_until ("hello", 1000), "hello");
+}
+
+TEST(stop_pauses_a_long_output_over_an_untimed_driver)
+{
+  tty_pair t
+    { "untimed", false };
+  ixon (t);
+
+  // nobody reads: the writer polls the driver for STOP between its writes
+  std::atomic<bool> done
+    { false };
+  std::thread lines
+    { [&t, &done]
+      {
+        for (int i = 0; i < 200; i++)
+          {
+            t.tty ().write ("0123456789\n", 11);
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+          }
+        done = true;
+      } };
+  std::string out = t.receive_until ("\n", 1000);
+  t.send ("\023");
+  std::this_thread::sleep_for (std::chrono::milliseconds (20));
+  out += t.receive ();
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+  CHECK(!done);
+  CHECK_STR(t.receive (), "");
+
+  t.send ("\021");
+  lines.join ();
+  for (int i = 0; i < 100 && out.size () < 200 * 12; i++)
+    {
+      out += t.receive (10);
+    }
+  CHECK_INT(out.size (), 200 * 12); // with ONLCR
+}
+
+TEST(ready_is_the_first_byte_kept_for_the_read)
+{
+  tty_pair t;
+  t.raw ();
+
+  CHECK(!t.tty ().wait_ready (10));
+  t.send ("k");
+  CHECK(t.tty ().wait_ready (10 * os::rtos::sysclock.frequency_hz));
+  char c = 0;
+  CHECK_INT(t.tty ().read (&c, 1), 1);
+  CHECK_INT(c, 'k');
+}
+
+TEST(a_driver_without_rx_wait_is_ready_with_the_first_byte)
+{
+  tty_pair t
+    { "untimed", false };
+  t.raw ();
+
+  // the read is timed by the driver, with VTIME
+  CHECK(!t.tty ().wait_ready (os::rtos::sysclock.frequency_hz / 10));
+  t.send ("k");
+  CHECK(t.tty ().wait_ready (10 * os::rtos::sysclock.frequency_hz));
+  char c = 0;
+  CHECK_INT(t.tty ().read (&c, 1), 1);
+  CHECK_INT(c, 'k');
+
+  // and then blocks again
+  struct termios tio;
+  t.impl ().do_tcgetattr (&tio);
+  CHECK_INT(tio.c_cc[VMIN], 1);
+  CHECK_INT(tio.c_cc[VTIME], 0);
+}
+
+TEST(ctrl_c_is_seen_while_writing_over_an_untimed_driver)
+{
+  tty_pair t
+    { "untimed", false };
+  t.raw ();
+  struct termios tio;
+  t.tty ().tcgetattr (&tio);
+  tio.c_lflag |= ISIG;
+  tio.c_cc[VINTR] = 3;
+  t.tty ().tcsetattr (TCSANOW, &tio);
+
+  // nobody reads; the command asks once per tick, with a read that does
+  // not wait
+  CHECK(!t.tty ().interrupted ());
+  t.send ("\x03");
+  bool intr = false;
+  for (int i = 0; i < 1000 && !intr; i++)
+    {
+      intr = t.tty ().interrupted ();
+      std::this_thread::sleep_for (std::chrono::milliseconds (1));
+    }
+  CHECK(intr);
+
+  t.impl ().do_tcgetattr (&tio);
+  CHECK_INT(tio.c_cc[VMIN], 1);
+  CHECK_INT(tio.c_cc[VTIME], 0);
+}
+
+int
+main (void)
+{
+  return test::run_tests ();
+}
@@ -0,0 +1,247 @@
+/*
+ * tty-tx-test.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "tty-canonical.h"
+#include "test.h"
+
+using os::posix::tty_canonical;
+
+// Built with a transmit queue (TTY_TX_BUFFER_LEN), unlike the shell's other
+// tests: output goes through the drain thread.
+
+namespace
+{
+  // a driver sending at most chunk bytes per write, pausing after each one,
+  // or failing; it reads input once
+  class trickle_impl : public os::posix::tty_timed_impl
+  {
+  public:
+
+    trickle_impl (void)
+    {
+      memset (&tio_, 0, sizeof(tio_));
+      tio_.c_cflag = CS8 | CREAD;
+      tio_.c_cc[VMIN] = 1;
+    }
+
+    virtual ssize_t
+    do_read (void* buf, std::size_t nbyte)
+    {
+      if (input.empty ())
+        {
+          errno = EIO;
+          return -1;
+        }
+      nbyte = std::min (nbyte, input.size ());
+      memcpy (buf, input.data (), nbyte);
+      input.erase (0, nbyte);
+      return nbyte;
+    }
+
+    virtual ssize_t
+    do_write (const void* buf, std::size_t nbyte)
+    {
+      std::lock_guard<std::mutex> lock
+        { mx };
+      writes++;
+      if (fail)
+        {
+          errno = EIO;
+          return -1;
+        }
+      nbyte = std::min (nbyte, chunk);
+      data.append (static_cast<const char*> (buf), nbyte);
+      std::this_thread::sleep_for (pause);
+      return nbyte;
+    }
+
+    virtual int
+    do_tcgetattr (struct termios* ptio)
+    {
+      memcpy (ptio, &tio_, sizeof(struct termios));
+      return 0;
+    }
+
+    virtual int
+    do_tcsetattr (int, const struct termios* ptio)
+    {
+      std::lock_guard<std::mutex> lock
+        { mx };
+      sent_at_setattr = data.size ();
+      memcpy (&tio_, ptio, sizeof(struct termios));
+      return 0;
+    }
+
+    virtual int
+    do_tcflush (int)
+    {
+      return 0;
+    }
+
+    virtual int
+    do_tcsendbreak (int)
+    {
+      return 0;
+    }
+
+    virtual int
+    do_tcdrain (void)
+    {
+      return 0;
+    }
+
+    virtual bool
+    do_rx_wait (os::rtos::clock::duration_t)
+    {
+      return false;
+    }
+
+    std::string
+    sent (void)
+    {
+      std::lock_guard<std::mutex> lock
+        { mx };
+      return data;
+    }
+
+    std::mutex mx;
+    std::string data;
+    std::string input;
+    std::size_t chunk = 5;
+    std::chrono::microseconds pause
+      { 0 };
+    bool fail = false;
+    int writes = 0;
+    std::size_t sent_at_setattr = 0;
+
+  private:
+
+    struct termios tio_;
+  };
+
+  std::string
+  text (std::size_t len)
+  {
+    std::string s;
+    for (std::size_t i = 0; i < len; i++)
+      {
+        s += static_cast<char> ('a' + i % 26);
+      }
+    return s;
+  }
+}
+
+TEST(short_writes_send_the_rest)
+{
+  trickle_impl impl;
+  tty_canonical tty
+    { impl, "tx-short" };
+  std::string out = text (3 * TTY_TX_BUFFER_LEN + 7);
+
+  CHECK_INT(tty.write (out.data (), out.size ()), (int ) out.size ());
+  tty.tcdrain ();
+  CHECK_STR(impl.sent (), out);
+}
+
+TEST(a_failed_write_drops_the_queue_and_is_reported)
+{
+  trickle_impl impl;
+  tty_canonical tty
+    { impl, "tx-fail" };
+  std::string out = text (2 * TTY_TX_BUFFER_LEN);
+
+  impl.fail = true;
+  // queued; the driver fails meanwhile, the writer does not wait for ever
+  CHECK_INT(tty.write (out.data (), out.size ()), (int ) out.size ());
+  tty.tcdrain ();
+  CHECK_INT(tty.write ("x", 1), -1);
+  CHECK_INT(errno, EIO);
+
+  // reported once, then sent again
+  impl.fail = false;
+  CHECK_INT(tty.write ("ok", 2), 2);
+  tty.tcdrain ();
+  CHECK_STR(impl.sent (), "ok");
+}
+
+TEST(the_echo_goes_ahead_of_queued_output)
+{
+  trickle_impl impl;
+  tty_canonical tty
+    { impl, "tx-echo" };
+  std::string out = text (TTY_TX_BUFFER_LEN - 8);
+  struct termios tio;
+
+  tty.tcgetattr (&tio);
+  tio.c_lflag |= ICANON | ECHO;
+  tio.c_oflag = 0;
+  tty.tcsetattr (TCSANOW, &tio);
+
+  impl.pause = std::chrono::milliseconds (5);
+  impl.input = "hi\n";
+  CHECK_INT(tty.write (out.data (), out.size ()), (int ) out.size ());
+
+  // read while the queue drains, the echo is sent between two chunks
+  char buf[8];
+  CHECK_INT(tty.read (buf, sizeof(buf)), 3);
+  tty.tcdrain ();
+
+  std::string sent = impl.sent ();
+  std::size_t pos = sent.find ("hi\n");
+  CHECK(pos != std::string::npos && pos < out.size ());
+  CHECK_STR(sent.erase (pos, 3), out);
+}
+
+TEST(settings_changed_after_a_drain_follow_the_queue)
+{
+  trickle_impl impl;
+  tty_canonical tty
+    { impl, "tx-drain" };
+  std::string out = text (3 * TTY_TX_BUFFER_LEN);
+  struct termios tio;
+
+  impl.pause = std::chrono::milliseconds (1);
+  tty.tcgetattr (&tio);
+  CHECK_INT(tty.write (out.data (), out.size ()), (int ) out.size ());
+
+  // like a session ending: the last output goes out with its settings
+  tty.tcsetattr (TCSADRAIN, &tio);
+  CHECK_INT(impl.sent_at_setattr, out.size ());
+  CHECK_STR(impl.sent (), out);
+}
+
+int
+main (void)
+{
+  return test::run_tests ();
+}
@@ -121,6 +121,55 @@ namespace ushell
 
   };
 
+#if SHELL_PIPE_SUPPORT == true
+
+  //----------------------------------------------------------------------------
+
+  class ush_grep : public ushell_cmd
+  {
+  public:
+
+    ush_grep (void);
+
+    virtual
+    ~ush_grep () noexcept;
+
+    virtual int
+    do_cmd (class ushell* ush, int argc, char* argv[]);
+
+  private:
+
+    static bool
+    match (const char* line, const char* pattern, bool icase);
+
+    static bool
+    match_rest (class ushell* ush, const char* line, const char* pattern,
+                bool icase, bool print);
+
+  };
+
+  //----------------------------------------------------------------------------
+
+  class ush_head : public ushell_cmd
+  {
+  public:
+
+    ush_head (void);
+
+    virtual
+    ~ush_head () noexcept;
+
+    virtual int
+    do_cmd (class ushell* ush, int argc, char* argv[]);
+
+  private:
+
+    static constexpr int default_lines = 10;
+
+  };
+
+#endif
+
 }
 
 #endif /* __cplusplus */
@@ -107,7 +107,7 @@ namespace ushell
   private:
 
     int
-    copy_file (char* src_path, char* dst_path);
+    copy_file (class ushell* ush, char* src_path, char* dst_path);
 
   };
 
@@ -144,7 +144,7 @@ namespace ushell
   private:
 
     int
-    empty_dir (char* path, size_t len);
+    empty_dir (class ushell* ush, char* path, size_t len);
 
   };
 
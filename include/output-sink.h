@@ -0,0 +1,199 @@
+/*
+ * output-sink.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * Output sinks: destinations for the output of shell commands. Commands
+ * write through ushell::printf (), putchar () and write (), the session
+ * buffers the output and hands it over to the sink selected for the current
+ * command invocation (the session tty by default).
+ */
+
+#ifndef OUTPUT_SINK_H_
+#define OUTPUT_SINK_H_
+
+#include <tty-canonical.h>
+#include <cmsis-plus/posix-io/io.h>
+
+#if defined (__cplusplus)
+
+namespace ushell
+{
+
+  class output_sink
+  {
+  public:
+
+    output_sink (void) = default;
+
+    output_sink (const output_sink&) = delete;
+
+    output_sink (output_sink&&) = delete;
+
+    output_sink&
+    operator= (const output_sink&) = delete;
+
+    output_sink&
+    operator= (output_sink&&) = delete;
+
+    virtual
+    ~output_sink () noexcept = default;
+
+    virtual ssize_t
+    write (const void* buf, std::size_t nbyte) = 0;
+
+    virtual int
+    flush (void);
+
+  };
+
+  //----------------------------------------------------------------------------
+
+  class tty_sink : public output_sink
+  {
+  public:
+
+    tty_sink (os::posix::tty_canonical* tty);
+
+    virtual ssize_t
+    write (const void* buf, std::size_t nbyte);
+
+  private:
+
+    os::posix::tty_canonical* tty_;
+
+  };
+
+  //----------------------------------------------------------------------------
+
+  class buffer_sink : public output_sink
+  {
+  public:
+
+    buffer_sink (char* buf, std::size_t len);
+
+    virtual ssize_t
+    write (const void* buf, std::size_t nbyte);
+
+    const char*
+    data (void) const;
+
+    std::size_t
+    size (void) const;
+
+    bool
+    overflow (void) const;
+
+    void
+    reset (void);
+
+  private:
+
+    char* buf_;
+    std::size_t len_;
+    std::size_t count_ = 0;
+    bool overflow_ = false;
+
+  };
+
+  //----------------------------------------------------------------------------
+
+  class file_sink : public output_sink
+  {
+  public:
+
+    file_sink (os::posix::io* file, std::size_t block = 0, off_t offset = 0);
+
+    virtual
+    ~file_sink () noexcept;
+
+    virtual ssize_t
+    write (const void* buf, std::size_t nbyte);
+
+    virtual int
+    flush (void);
+
+    int
+    error (void) const;
+
+  protected:
+
+    os::posix::io* file_;
+    int error_ = 0;             // errno of the first failed write, 0 if none
+
+    // write-behind buffer, one block; the file is written in whole blocks,
+    // aligned to the block size, except when explicitly flushed
+    char* buf_ = nullptr;
+    std::size_t block_;
+    std::size_t fill_ = 0;      // bytes in the buffer
+    off_t offset_;              // file offset of the first buffered byte
+
+  };
+
+  //----------------------------------------------------------------------------
+
+  /**
+   * @brief Return the collected output, always null terminated.
+   */
+  inline const char*
+  buffer_sink::data (void) const
+  {
+    return buf_;
+  }
+
+  /**
+   * @brief Return the number of bytes collected, without the terminator.
+   */
+  inline std::size_t
+  buffer_sink::size (void) const
+  {
+    return count_;
+  }
+
+  /**
+   * @brief Return true if some output was dropped because the buffer was full.
+   */
+  inline bool
+  buffer_sink::overflow (void) const
+  {
+    return overflow_;
+  }
+
+  /**
+   * @brief Return the errno of the first write to the file that failed or
+   *  was short, 0 if all data was written so far.
+   */
+  inline int
+  file_sink::error (void) const
+  {
+    return error_;
+  }
+
+}
+
+#endif /* __cplusplus */
+
+#endif /* OUTPUT_SINK_H_ */
@@ -49,13 +49,13 @@ namespace ushell
     char*
     get (void);
 
-    void
+    int
     to_absolute (const char* path, char* result, size_t len);
 
     void
     back (const char* path);
 
-    void
+    int
     forward (const char* level, char* result, size_t len);
 
     int
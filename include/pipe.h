@@ -0,0 +1,106 @@
+/*
+ * pipe.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * Bounded pipe connecting two stages of a command pipeline. It is a single
+ * producer, single consumer ring buffer: the writer only advances the head,
+ * the reader only advances the tail, and neither side takes a lock; the
+ * binary semaphores are only used to sleep when the buffer is full or empty.
+ */
+
+#ifndef PIPE_H_
+#define PIPE_H_
+
+#include <atomic>
+
+#include <cmsis-plus/rtos/os.h>
+#include "output-sink.h"
+
+#if defined (__cplusplus)
+
+namespace ushell
+{
+
+  class ring_pipe : public output_sink
+  {
+  public:
+
+    ring_pipe (std::size_t len);
+
+    virtual
+    ~ring_pipe () noexcept;
+
+    virtual ssize_t
+    write (const void* buf, std::size_t nbyte);
+
+    ssize_t
+    read (void* buf, std::size_t nbyte);
+
+    void
+    close_write (void);
+
+    void
+    close_read (void);
+
+    bool
+    valid (void) const;
+
+  private:
+
+    char* buf_;
+    std::size_t len_;           // a power of two, positions are masked
+
+    std::atomic<std::size_t> head_
+      { 0 };    // bytes written so far, modified by the writer only
+    std::atomic<std::size_t> tail_
+      { 0 };    // bytes read so far, modified by the reader only
+    std::atomic<bool> wclosed_
+      { false };
+    std::atomic<bool> rclosed_
+      { false };
+
+    os::rtos::semaphore_binary readable_
+      { "pipe-rd", 0 };
+    os::rtos::semaphore_binary writable_
+      { "pipe-wr", 0 };
+
+  };
+
+  /**
+   * @brief Return false if the pipe's buffer could not be allocated.
+   */
+  inline bool
+  ring_pipe::valid (void) const
+  {
+    return buf_ != nullptr;
+  }
+
+}
+
+#endif /* __cplusplus */
+
+#endif /* PIPE_H_ */
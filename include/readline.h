@@ -43,8 +43,6 @@
 #include "tty-canonical.h"
 #include "ushell-opts.h"
 
-#include <cmsis-plus/posix-io/chan-fatfs-file-system.h>
-
 #if defined (__cplusplus)
 
 #if !defined SHELL_UTF8_SUPPORT
@@ -55,13 +53,102 @@
 #define SHELL_MAX_LINE_LEN 256
 #endif
 
+#if !defined SHELL_RENDER_BUFFER_LEN
+#define SHELL_RENDER_BUFFER_LEN 128
+#endif
+
 #if !defined SHELL_FILE_HISTORY_LEN
 #define SHELL_FILE_HISTORY_LEN 1024
 #endif
 
+// history file: entries are appended in writes of up to this size
+#if !defined SHELL_HISTORY_BLOCK_LEN
+#define SHELL_HISTORY_BLOCK_LEN 512
+#endif
+
+// history file: compacted when it grows beyond this size
+#if !defined SHELL_HISTORY_JOURNAL_LEN
+#define SHELL_HISTORY_JOURNAL_LEN (4 * SHELL_FILE_HISTORY_LEN)
+#endif
+
+// history file: seconds without input before pending entries are written;
+// until then, or until a block fills or the session ends, a reset loses
+// them; 0 writes each entry as it is entered
+#if !defined SHELL_HISTORY_SYNC_TIME
+#define SHELL_HISTORY_SYNC_TIME 5
+#endif
+
+// milliseconds to wait for the rest of an escape sequence; a lone ESC is
+// told apart by this
+#if !defined SHELL_ESC_TIMEOUT
+#define SHELL_ESC_TIMEOUT 100
+#endif
+
 namespace ushell
 {
 
+  /**
+   * @brief Count the nodes of the trie built from the sequences of a
+   *  command table that lead further, i.e. the distinct proper prefixes
+   *  plus the root; a complete sequence is a command, not a node.
+   * @param cmds: the command table.
+   * @return Number of nodes.
+   */
+  template<typename T, std::size_t N>
+    constexpr std::size_t
+    rl_trie_size (const T (&cmds)[N])
+    {
+      std::size_t count = 1;
+
+      for (std::size_t i = 0; i < N; i++)
+        {
+          for (std::size_t k = 1; cmds[i].seq[k] != '\0'; k++)
+            {
+              bool seen = false;
+              for (std::size_t j = 0; j < i && !seen; j++)
+                {
+                  std::size_t m = 0;
+                  while (m < k && cmds[j].seq[m] == cmds[i].seq[m])
+                    {
+                      m++;
+                    }
+                  seen = (m == k);
+                }
+              count += seen ? 0 : 1;
+            }
+        }
+      return count;
+    }
+
+  /**
+   * @brief Count the distinct bytes used by the sequences of a command
+   *  table, i.e. the columns of the trie's transition table, plus one for
+   *  the bytes used by none.
+   * @param cmds: the command table.
+   * @return Number of columns.
+   */
+  template<typename T, std::size_t N>
+    constexpr std::size_t
+    rl_trie_columns (const T (&cmds)[N])
+    {
+      bool used[256] =
+        { };
+      std::size_t count = 1;
+
+      for (std::size_t i = 0; i < N; i++)
+        {
+          for (const char* p = cmds[i].seq; *p != '\0'; p++)
+            {
+              if (!used[static_cast<uint8_t> (*p)])
+                {
+                  used[static_cast<uint8_t> (*p)] = true;
+                  count++;
+                }
+            }
+        }
+      return count;
+    }
+
   class read_line
   {
 
@@ -92,7 +179,8 @@ namespace ushell
     initialise (os::posix::tty_canonical* tty);
 
     int
-    readline (const char* prompt, void* buff, size_t len);
+    readline (const char* prompt, void* buff, size_t len,
+              unsigned int timeout = 0);
 
     void
     end (void);
@@ -101,15 +189,66 @@ namespace ushell
 
     typedef unsigned int rl_glyph_t;
 
+    static int
+    trie_step (int node, char ch);
+
+    bool
+    process_input (void);
+
+    void
+    dispatch (char ch);
+
+    size_t
+    text_run (const char* p, size_t len);
+
+    void
+    insert_run (const char* p, size_t len);
+
     bool
-    exec_seq (char* seq);
+    history_valid (void);
+
+    bool
+    history_check (int rec);
+
+    static uint16_t
+    crc16 (uint16_t crc, const void* data, size_t len);
+
+    void
+    history_reset (void);
 
     void
     history_add (const char* string);
 
+    int
+    history_next (int rec);
+
+    void
+    history_save (void);
+
+    void
+    history_show (int rec);
+
+    bool
+    history_put (const char* string);
+
+    bool
+    journal_replay (void);
+
+    void
+    journal_append (const char* string, size_t len);
+
+    void
+    journal_flush (void);
+
+    bool
+    journal_compact (void);
+
     int
     out (const char* data, int size);
 
+    void
+    flush (void);
+
     rl_glyph_t
     utf8_to_glyph (const char** utf8);
 
@@ -152,19 +291,59 @@ namespace ushell
     os::rtos::mutex rlmx_
       { "rl-mutex" };
 
+    // The history is a circular log of records, each a header followed by
+    // the text and its terminator; a record never wraps, a header with a
+    // zero length (or no room for one) sends the reader back to the start.
+    // The log header in front of it keeps the state across restarts. The
+    // header and each record carry a CRC, so a damaged record costs only
+    // itself and the records older than it.
     typedef struct hist_header
     {
-      int16_t prev;
-      int16_t next;
+      uint16_t len;     // length of the text, terminator included
+      uint16_t prev;    // offset of the previous (older) record
+      uint16_t crc;     // of the above and the text
     } hh_t;
 
+    typedef struct hist_log
+    {
+      uint8_t magic;
+      uint8_t version;
+      uint16_t head;    // where the next record goes
+      uint16_t tail;    // oldest record
+      uint16_t newest;  // newest record, or hist_none if empty
+      uint16_t crc;     // of the above
+    } hl_t;
+
+    static constexpr uint8_t hist_magic = 0xA5;
+    static constexpr uint8_t hist_version = 3;
+    static constexpr int hist_none = 0xFFFF;
+
     rl_get_completion_fn* get_completion_;
 
     char* history_;
     size_t hist_len_;
-    char* current_;
+    hl_t hl_;
+    int current_ = hist_none; // record shown, or none for the new line
     const char* file_;
 
+    // The history file is a journal: a two byte header (magic, version)
+    // followed by the entries, in the order they were added; it is
+    // replayed at start-up, and compacted to the history log when too big.
+    typedef struct journal_header
+    {
+      uint16_t len;     // length of the text, terminator included
+      uint16_t crc;     // of the length and the text
+    } jh_t;
+
+    static constexpr uint8_t journal_magic = 0x5A;
+    static constexpr uint8_t journal_version = 1;
+
+    char* jbuf_ = nullptr;      // entries not written yet
+    size_t jlen_ = 0;
+    size_t jsize_ = 0;          // size of the file
+    bool jstale_ = false;       // entries missing, compact at the next flush
+    char* jtmp_ = nullptr;      // name of the file while compacted
+
     char* raw_ = nullptr; // raw buffer, utf-8
     size_t raw_len_ = 0;  // length of the raw buffer
 
@@ -175,9 +354,32 @@ namespace ushell
     int cur_pos_ = 0;   // position in glyphs
     bool finish_ = false;
 
+    // bytes read from the tty, kept across lines, e.g. when pasting
+    char in_[32];
+    uint8_t in_pos_ = 0;
+    uint8_t in_len_ = 0;
+
+    // the key sequence being received
+    char seq_[12];
+    uint8_t seq_len_ = 0;
+    uint8_t node_ = 0;  // state in the trie of the command sequences
+    bool skip_ = false; // unknown sequence, swallowed up to its end
+    bool paste_ = false; // within a bracketed paste
+    bool paste_cr_ = false; // the last pasted line ended with a CR
+
+    // output of one keystroke, written to the tty at once
+    char rbuf_[SHELL_RENDER_BUFFER_LEN];
+    int rlen_ = 0;
+
     os::posix::tty_canonical* tty_ = nullptr;
 
     static constexpr const char* bs = "\b";
+    static constexpr const char* erase_eol = "\033[K";
+
+    // bracketed paste: on/off, and the marker ending a paste
+    static constexpr const char* paste_on = "\033[?2004h";
+    static constexpr const char* paste_off = "\033[?2004l";
+    static constexpr char paste_stop[] = "\033[201~";
 
     //--------------------------------------------------------------------------
 
@@ -232,6 +434,15 @@ namespace ushell
     static void
     enter (class read_line* rl);
 
+    static void
+    cancel (class read_line* rl);
+
+    static void
+    paste_begin (class read_line* rl);
+
+    static void
+    paste_end (class read_line* rl);
+
     static void
     autocomplete (class read_line* rl);
 
@@ -262,6 +473,7 @@ namespace ushell
             { "\016", history_forward },
             { "\033<", history_begin },
             { "\033>", history_end },
+            { "\003", cancel },
 
           // VT100
             { "\033OH", cursor_home },
@@ -293,11 +505,35 @@ namespace ushell
             { "\033C", cursor_right },
             { "\033K", delete_to_end },
 
+          // bracketed paste
+            { "\033[200~", paste_begin },
+            { "\033[201~", paste_end },
+
             { "\n", enter },
             { "\r", enter },
 
       };
 
+    // the sequences above as a trie, built at compile time; a received
+    // byte moves from a node to the next one, looked up in a table indexed
+    // by the node and the byte's column; the last byte of a sequence leads
+    // to its command instead, numbered after the nodes
+    static constexpr std::size_t rl_trie_len = rl_trie_size (rl_commands);
+    static constexpr std::size_t rl_trie_cols = rl_trie_columns (rl_commands);
+
+    typedef struct
+    {
+      uint8_t col[256]; // column of each byte, 0 if in no sequence
+      uint8_t next[rl_trie_len][rl_trie_cols]; // by column, 0 if none
+      bool ambiguous;   // a sequence is the prefix of another one
+      bool printable;   // a sequence starts with a printable character
+    } rl_trie_t;
+
+    static constexpr rl_trie_t
+    make_trie (void);
+
+    static const rl_trie_t rl_trie_;
+
   };
 
 }
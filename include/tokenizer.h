@@ -0,0 +1,69 @@
+/*
+ * tokenizer.h
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ *
+ * Splits a command line into arguments, in place. Arguments are separated by
+ * spaces or tabs; single quotes preserve everything up to the closing quote,
+ * double quotes preserve everything except \" and \\, and outside quotes a
+ * backslash escapes the next character. Quoted and unquoted parts next to
+ * each other form a single argument (e.g. a"b c"d -> ab cd). An unterminated
+ * quote ends at the end of the line.
+ *
+ * This differs from the parser of ushell 0.4.x, which only knew double quotes
+ * at the start of an argument: a backslash outside quotes is now an escape
+ * and is dropped (write \\ for a literal one, e.g. in a\\b), single quotes
+ * now quote, and a quote within an argument starts a quoted part instead of
+ * being kept as it is.
+ */
+
+#ifndef TOKENIZER_H_
+#define TOKENIZER_H_
+
+#if defined (__cplusplus)
+
+namespace ushell
+{
+
+  class tokenizer
+  {
+  public:
+
+    tokenizer (void) = delete;
+
+    static int
+    split (char* line, char* argv[], int max);
+
+    static char*
+    find_unquoted (char* line, char c);
+
+  };
+
+}
+
+#endif /* __cplusplus */
+
+#endif /* TOKENIZER_H_ */
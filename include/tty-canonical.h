@@ -48,6 +48,30 @@
 
 // ----------------------------------------------------------------------------
 
+// These can be overridden from os-app-config.h or from the command line.
+
+#if !defined TTY_INPUT_BUFFER_LEN
+#define TTY_INPUT_BUFFER_LEN 64 // input ring buffer, a power of two
+#endif
+
+#if !defined TTY_ECHO_BUFFER_LEN
+#define TTY_ECHO_BUFFER_LEN 32 // echo collected before a write
+#endif
+
+#if !defined TTY_OUTPUT_STAGE_LEN
+#define TTY_OUTPUT_STAGE_LEN 128 // on the stack of the writer
+#endif
+
+#if !defined TTY_TX_BUFFER_LEN
+#define TTY_TX_BUFFER_LEN 0 // transmit queue, a power of two; 0 = none
+#endif
+
+#if !defined TTY_TX_STACK_SIZE
+#define TTY_TX_STACK_SIZE 1024 // stack of the thread draining the queue
+#endif
+
+// ----------------------------------------------------------------------------
+
 namespace os
 {
   namespace posix
@@ -58,6 +82,48 @@ namespace os
 
     // ========================================================================
 
+    /**
+     * @brief Optional extension of the driver interface, for the timers of
+     *  the line discipline (VTIME, wait_input ()). The driver is set up for
+     *  blocking reads (VMIN = 1, VTIME = 0); while a timer runs, a driver
+     *  derived from this class is waited on with do_rx_wait (), any other
+     *  gets VMIN = 0 and VTIME for that one read, and must honour them.
+     *  While nobody reads, writers poll the input for START/STOP and INTR,
+     *  with do_rx_wait (0) here, else with a read with VMIN = VTIME = 0.
+     */
+    class tty_timed_impl : public tty_impl
+    {
+    public:
+
+      /**
+       * @brief Wait for received data; typically a timed wait on the
+       *  semaphore posted by the receive interrupt.
+       * @param timeout: maximum time to wait, in system ticks; 0 not to wait.
+       * @return true if a read would not block, false otherwise.
+       */
+      virtual bool
+      do_rx_wait (os::rtos::clock::duration_t timeout) = 0;
+
+      /**
+       * @brief Wait for someone to be there, before a session starts; a
+       *  driver knowing the carrier or DTR state waits for it here. By
+       *  default, the first received byte is the signal.
+       * @param timeout: maximum time to wait, in system ticks.
+       * @return true if the line is ready, false if the time expired.
+       */
+      virtual bool
+      do_ready_wait (os::rtos::clock::duration_t timeout);
+
+    };
+
+    inline bool
+    tty_timed_impl::do_ready_wait (os::rtos::clock::duration_t timeout)
+    {
+      return do_rx_wait (timeout);
+    }
+
+    // ========================================================================
+
     class tty_canonical : public tty
     {
       // ----------------------------------------------------------------------
@@ -71,6 +137,8 @@ namespace os
 
       tty_canonical (tty_impl& impl, const char* name);
 
+      tty_canonical (tty_timed_impl& impl, const char* name);
+
       /**
        * @cond ignore
        */
@@ -128,6 +196,18 @@ namespace os
       virtual ssize_t
       write (const void* buf, std::size_t nbyte);
 
+      int
+      wait_input (os::rtos::clock::duration_t timeout);
+
+      bool
+      wait_ready (os::rtos::clock::duration_t timeout);
+
+      bool
+      interrupted (void);
+
+      bool
+      clear_interrupt (void);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -139,25 +219,100 @@ namespace os
       ssize_t
       get_line (void* buf, std::size_t nbyte);
 
+      ssize_t
+      get_raw (void* buf, std::size_t nbyte);
+
       ssize_t
       process_input (void* buf, ssize_t nbyte);
 
+      void
+      build_input_table (void);
+
+      ssize_t
+      fill_input (bool block = true);
+
+      ssize_t
+      fill_input_timed (os::rtos::clock::duration_t timeout);
+
+      ssize_t
+      fill_input_vtime (os::rtos::clock::duration_t timeout);
+
+      void
+      rx_timeout (os::rtos::clock::duration_t timeout);
+
+      void
+      rx_block (void);
+
+      std::size_t
+      read_input (void* buf, std::size_t nbyte);
+
+      std::size_t
+      scan_input (char* buf, std::size_t nbyte);
+
+      void
+      poll_input (void);
+
+      ssize_t
+      read_ahead (void);
+
+      void
+      wait_start (void);
+
+      void
+      input_release (void);
+
+      void
+      input_resume (void);
+
+      void
+      flow_control (void);
+
       void
       echo_char (char c);
 
+      void
+      echo_flush (void);
+
+      void
+      out_direct (const void* buf, std::size_t nbyte);
+
+      ssize_t
+      out_write (const void* buf, std::size_t nbyte);
+
+#if TTY_TX_BUFFER_LEN > 0
+      bool
+      tx_start (void);
+
+      ssize_t
+      tx_enqueue (const void* buf, std::size_t nbyte);
+
+      bool
+      tx_empty (void);
+
+      std::size_t
+      tx_room (void);
+
+      static void*
+      tx_th (void* args);
+#endif
+
       ssize_t
       put_line (const void* buf, std::size_t nbyte);
 
+      static constexpr uint8_t ctrl_c = 3;      // interrupt
       static constexpr uint8_t bell = 7;        // bell
       static constexpr uint8_t ctrl_d = 4;      // end of file
       static constexpr uint8_t ctrl_u = 0x15;   // line kill
       static constexpr uint8_t esc = 0x1B;      // escape
+      static constexpr uint8_t ctrl_q = 0x11;   // XON
+      static constexpr uint8_t ctrl_s = 0x13;   // XOFF
 
       typedef struct
       {
         bool icanon;    // canonicalize input lines
         bool echo;      // enable echoing
         bool echoe;     // echo erase character as BS-SP-BS
+        bool isig;      // enable signals INTR -> interrupted() is raised
       } lflag_t;
 
       typedef struct
@@ -167,6 +322,8 @@ namespace os
         bool igncr;     // ignore CR -> CRs are filtered out
         bool inlcr;     // map NL into CR -> replaces NLs with CRs
         bool imaxbel;   // ring bell on input queue full
+        bool ixon;      // enable output flow control -> START/STOP filtered
+        bool ixoff;     // enable input flow control -> START/STOP sent
       } iflag_t;
 
       typedef struct
@@ -183,21 +340,90 @@ namespace os
         uint8_t veol2;  // second end of line character (LF)
         uint8_t verase; // erase character, default backspace
         uint8_t vkill;  // kill character, default ^U
+        uint8_t vstart; // start output, default ^Q
+        uint8_t vstop;  // stop output, default ^S
+        uint8_t vintr;  // interrupt, default ^C
+        uint8_t vmin;   // minimum bytes for a non-canonical read
+        uint8_t vtime;  // non-canonical read timer, in tenths of a second
       } ctrlc_t;
 
       lflag_t lf_ =
-        { .icanon = false, .echo = false, .echoe = false };
+        { .icanon = false, .echo = false, .echoe = false, .isig = false };
 
       iflag_t if_ =
         { .istrip = false, .icrnl = false, .igncr = false, .inlcr = false,
-            .imaxbel = false };
+            .imaxbel = false, .ixon = false, .ixoff = false };
 
       oflag_t of_ =
         { .opost = false, .onlcr = false, .ocrnl = false };
 
       ctrlc_t cc_ =
         { .veof = ctrl_d, .veol = '\r', .veol2 = '\n', .verase = '\b', .vkill =
-            ctrl_u };
+            ctrl_u, .vstart = ctrl_q, .vstop = ctrl_s, .vintr = ctrl_c, .vmin =
+            1, .vtime = 0 };
+
+      // input translation by byte value, built from if_ by tcsetattr();
+      // a set bit in idrop_ means the byte is discarded (IGNCR)
+      uint8_t ixlat_[256];
+      uint32_t idrop_[256 / 32];
+      bool ixlat_on_ = false;
+
+      static_assert((TTY_INPUT_BUFFER_LEN & (TTY_INPUT_BUFFER_LEN - 1)) == 0,
+          "TTY_INPUT_BUFFER_LEN must be a power of two");
+
+      // bytes read from the driver but not yet consumed; the indexes are
+      // free running, masked on access
+      char ibuf_[TTY_INPUT_BUFFER_LEN];
+      std::size_t ihead_ = 0;   // bytes read from the driver so far
+      std::size_t itail_ = 0;   // bytes consumed so far
+      os::rtos::mutex imx_
+        { "tty-rx" };   // held by the reader, or a writer waiting for START
+      volatile bool iflush_ = false;    // TCIFLUSH, for the holder of imx_
+
+      // software flow control
+      volatile bool ostopped_ = false;  // STOP received, output paused
+      volatile bool intr_ = false;      // INTR received, not yet cleared
+      bool isent_stop_ = false;         // STOP sent, input paused
+      volatile bool iwait_ = false;     // a reader waits, the ring is empty
+      os::rtos::clock::timestamp_t polled_ = 0;
+      struct termios tio_;              // as last set on the driver
+
+      tty_timed_impl* timed_ = nullptr; // the driver, if it has do_rx_wait ()
+
+      // echo collected while a batch of input is processed
+      char ebuf_[TTY_ECHO_BUFFER_LEN];
+      std::size_t elen_ = 0;
+
+#if TTY_TX_BUFFER_LEN > 0
+      static_assert((TTY_TX_BUFFER_LEN & (TTY_TX_BUFFER_LEN - 1)) == 0,
+          "TTY_TX_BUFFER_LEN must be a power of two");
+
+      static constexpr std::size_t tx_chunk = 64; // max bytes per driver write
+
+      // output queued for the drain thread; the indexes are free running
+      char txbuf_[TTY_TX_BUFFER_LEN];
+      std::size_t txhead_ = 0;  // bytes queued so far
+      std::size_t txtail_ = 0;  // bytes sent so far
+      bool txstop_ = false;
+      // the driver failed sending the queue, reported to the next writer
+      volatile bool txerr_ = false;
+      int txerrno_ = 0;
+      os::rtos::thread* txth_ = nullptr;
+      // one writer at a time, keeps writes in one piece; recursive, as a
+      // writer may have to send STOP while it polls the input
+      os::rtos::mutex txwmx_
+        { "tty-tx", os::rtos::mutex::initializer_recursive };
+      // held by the drain thread while it sends from the queue, so that a
+      // flush cannot free the bytes it is sending
+      os::rtos::mutex txdmx_
+        { "tty-txq" };
+      os::rtos::semaphore_binary txdata_
+        { "tty-txd", 0 };
+      os::rtos::semaphore_binary txspace_
+        { "tty-txs", 0 };
+      os::rtos::semaphore_binary txidle_
+        { "tty-txi", 0 };
+#endif
 
     };
 
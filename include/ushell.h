@@ -32,6 +32,7 @@
 
 #include <tty-canonical.h> // this is temporary, should be <tty.h>
 #include "readline.h"
+#include "output-sink.h"
 #include "ushell-opts.h"
 
 #if defined (__cplusplus)
@@ -40,8 +41,60 @@
 #define SHELL_MAX_LINE_LEN 256
 #endif
 
-#if !defined SHELL_MAX_COMMANDS
-#define SHELL_MAX_COMMANDS 40
+#if !defined SHELL_CMD_INDEX_LEN
+#define SHELL_CMD_INDEX_LEN 32 // number of hash buckets, a power of two
+#endif
+
+#if !defined SHELL_STATIC_COMMANDS
+#define SHELL_STATIC_COMMANDS false
+#endif
+
+#if !defined SHELL_OUTPUT_BUFFER_LEN
+#define SHELL_OUTPUT_BUFFER_LEN 256
+#endif
+
+#if !defined SHELL_PIPE_SUPPORT
+#define SHELL_PIPE_SUPPORT false
+#endif
+
+#if !defined SHELL_PIPE_BUFFER_LEN
+#define SHELL_PIPE_BUFFER_LEN 512 // bytes of buffer per pipe
+#endif
+
+#if !defined SHELL_PIPE_MAX_STAGES
+#define SHELL_PIPE_MAX_STAGES 4
+#endif
+
+#if !defined SHELL_PIPE_STACK_SIZE
+#define SHELL_PIPE_STACK_SIZE 2048 // stack of the threads running the stages
+#endif
+
+#if SHELL_PIPE_SUPPORT == true
+#include "pipe.h"
+#endif
+
+#if !defined SHELL_REDIRECT_MAX_BUFFER
+#define SHELL_REDIRECT_MAX_BUFFER 4096 // cap of the write-behind buffer
+#endif
+
+#if !defined SHELL_IDLE_TIMEOUT
+#define SHELL_IDLE_TIMEOUT 0 // seconds without input closing the session
+#endif
+
+#if !defined SHELL_START_TIMEOUT
+#define SHELL_START_TIMEOUT 2 // max seconds to wait for the line, 0 = no wait
+#endif
+
+#if !defined SHELL_FLOW_CONTROL
+#define SHELL_FLOW_CONTROL false // XON/XOFF on the session's tty
+#endif
+
+#if !defined SHELL_ISIG
+#define SHELL_ISIG false // ctrl-c cancels a command, or the line being edited
+#endif
+
+#if !defined SHELL_RETRY_DELAY
+#define SHELL_RETRY_DELAY 100 // ms, doubled with each failed session in a row
 #endif
 
 #if !defined SHELL_USE_READLINE
@@ -58,8 +111,20 @@
 
 namespace ushell
 {
+  class ushell;
   class ushell_cmd;
 
+  // handler and descriptor of a command in the compile-time registry
+  typedef int
+  (*cmd_handler_t) (class ushell* ush, int argc, char* argv[]);
+
+  typedef struct
+  {
+    const char* command;
+    const char* help_text;
+    cmd_handler_t handler;
+  } static_cmd_t;
+
   typedef enum
   {
     ush_ok = 0,
@@ -68,6 +133,7 @@ namespace ushell
     ush_option_invalid,
     unused,
     ush_param_invalid,
+    ush_write_error,
 
     out_of_memory = 30,
 
@@ -107,16 +173,50 @@ namespace ushell
     static bool
     link_cmd (class ushell_cmd* ucmd);
 
+    static void
+    unlink_cmd (class ushell_cmd* ucmd);
+
+    // iterate the linked commands, in link order; the command returned is
+    // held, i.e. it cannot be unlinked, until it is passed to next_cmd () or,
+    // when leaving the loop early, to release_cmd ()
+    static ushell_cmd*
+    first_cmd (void);
+
+    static ushell_cmd*
+    next_cmd (ushell_cmd* ucmd);
+
+    static void
+    release_cmd (ushell_cmd* ucmd);
+
     int
     printf (const char* format, ...);
 
     int
     getchar (void);
 
+    int
+    read (void* buf, size_t nbyte);
+
+    int
+    getline (char* buf, size_t len, bool* more = nullptr);
+
+    bool
+    piped_input (void);
+
+    bool
+    cancelled (void);
+
     int
     putchar (int c);
 
-    static ushell_cmd* ushell_cmds_[SHELL_MAX_COMMANDS];
+    int
+    write (const void* buf, size_t nbyte);
+
+    int
+    flush (void);
+
+    int
+    exec (char* line, output_sink* sink);
 
 #if SHELL_FILE_SUPPORT == true
     path ph
@@ -127,7 +227,26 @@ namespace ushell
 
   protected:
 
-    os::posix::tty_canonical* tty;
+    // the session's tty; nullptr while none is open, e.g. for exec ()
+    os::posix::tty_canonical* tty = nullptr;
+
+    // output coalescing buffer, flushed to the current sink at the end of
+    // each command, before reading from the tty and when full
+    char obuf_[SHELL_OUTPUT_BUFFER_LEN];
+    size_t olen_ = 0;
+    output_sink* out_ = nullptr;
+
+#if SHELL_PIPE_SUPPORT == true
+    // input of a pipeline stage; nullptr when reading from the tty
+    ring_pipe* in_ = nullptr;
+#endif
+
+    // failed sessions in a row, see do_ushell ()
+    unsigned int backoff_ = 0;
+
+    // serialises exec () with the session's own commands
+    os::rtos::mutex exmx_
+      { "ush-exec", os::rtos::mutex::initializer_recursive };
 
     //--------------------------------------------------------------------------
 
@@ -136,6 +255,76 @@ namespace ushell
     int
     cmd_parser (char* buff);
 
+#if SHELL_FILE_SUPPORT == true
+    int
+    redirect (char* line, char* op);
+#endif
+
+#if SHELL_PIPE_SUPPORT == true
+    ushell (const ushell* parent);
+
+    int
+    pipeline (char* line);
+
+    typedef struct
+    {
+      ushell* ush;
+      char* line;
+      ring_pipe* in;
+      ring_pipe* out;
+      os::rtos::thread* th;
+      int result;
+    } stage_t;
+
+    static void*
+    stage_th (void* args);
+#endif
+
+    static ushell_cmd*
+    find_cmd (const char* name);
+
+#if SHELL_STATIC_COMMANDS == true
+    static const static_cmd_t*
+    find_static_cmd (const char* name);
+#endif
+
+    static ushell_cmd*
+    lookup_cmd (const char* name);
+
+    static void
+    index_pending (ushell_cmd** list);
+
+    static uint32_t
+    hash (const char* name);
+
+    static void
+    hlist_add (ushell_cmd** head, ushell_cmd* ucmd);
+
+    static void
+    hlist_del (ushell_cmd* ucmd);
+
+    static void
+    drop (ushell_cmd* ucmd);
+
+    static_assert((SHELL_CMD_INDEX_LEN & (SHELL_CMD_INDEX_LEN - 1)) == 0,
+        "SHELL_CMD_INDEX_LEN must be a power of two");
+
+    // all linked commands, in link order
+    static ushell_cmd* first_;
+    static ushell_cmd* last_;
+
+    // hash index over the linked commands, chained buckets
+    static ushell_cmd* cmd_index_[SHELL_CMD_INDEX_LEN];
+
+    // commands linked, but not indexed yet (their name is set after linking)
+    static ushell_cmd* pending_;
+
+    // commands which had no name yet when indexed; retried on a failed lookup
+    static ushell_cmd* unnamed_;
+
+    // order of the next command linked
+    static uint32_t link_order_;
+
     const char* char_device_;
 
     read_line* rl_;
@@ -161,6 +350,32 @@ namespace ushell
     version_patch = VERSION_PATCH;
   }
 
+  /**
+   * @brief Tell if the command's input comes from a previous pipeline stage.
+   * @return true if reading from a pipe, false if reading from the tty.
+   */
+  inline bool
+  ushell::piped_input (void)
+  {
+#if SHELL_PIPE_SUPPORT == true
+    return in_ != nullptr;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * @brief Tell if the user asked to stop the running command with the
+   *  interrupt character (ctrl-c); cheap enough to be called in the loops
+   *  of long running commands.
+   * @return true if the command should stop.
+   */
+  inline bool
+  ushell::cancelled (void)
+  {
+    return tty != nullptr && tty->interrupted ();
+  }
+
   //----------------------------------------------------------------------------
 
   class ushell_cmd
@@ -179,6 +394,10 @@ namespace ushell
     ushell_cmd&
     operator= (ushell_cmd&&) = delete;
 
+    // unlinks the command; a derived class had better call
+    // ushell::unlink_cmd (this) from its own destructor, while the object
+    // is still whole, since a lookup running while the derived part is
+    // destroyed would still find the command
     virtual
     ~ushell_cmd () noexcept;
 
@@ -202,10 +421,114 @@ namespace ushell
     cmd_info_t info_;
     class ushell* ush;
 
+  private:
+
+    // intrusive links, owned by the ushell class
+    ushell_cmd* next_ = nullptr;        // registry, in link order
+    ushell_cmd* prev_ = nullptr;
+    ushell_cmd* hash_next_ = nullptr;   // hash bucket or pending list
+    ushell_cmd** hash_pprev_ = nullptr;
+    volatile unsigned int users_ = 0;   // running invocations and iterators
+    uint32_t order_ = 0;                // link order, for name clashes
+    os::rtos::semaphore_binary* released_ = nullptr; // unlink_cmd () waiting
+    bool linked_ = false;
+
   };
 
+  //----------------------------------------------------------------------------
+
+  /*
+   * Compile-time command registry (opt-in, SHELL_STATIC_COMMANDS true).
+   *
+   * Commands which need no state can be described by a plain handler
+   * function instead of a ushell_cmd object. The descriptors are listed once,
+   * in any order, with the SHELL_STATIC_CMD_TABLE macro in exactly one source
+   * file of the application, e.g.:
+   *
+   *   SHELL_STATIC_CMD_TABLE(
+   *       { "reset", "Reset the system", do_reset },
+   *       { "adc", "Show the ADC readings", do_adc });
+   *
+   * The table is sorted at compile time and placed in flash; no constructors
+   * run at startup and the lookup is a binary search. Static commands take
+   * precedence over linked (dynamic) commands with the same name.
+   */
+
+  /**
+   * @brief Case insensitive comparison of two command names.
+   * @return <0, 0 or >0, like strcasecmp ().
+   */
+  constexpr int
+  cmd_name_cmp (const char* a, const char* b)
+  {
+    char ca = 0, cb = 0;
+
+    do
+      {
+        ca = (*a >= 'A' && *a <= 'Z') ? *a - 'A' + 'a' : *a;
+        cb = (*b >= 'A' && *b <= 'Z') ? *b - 'A' + 'a' : *b;
+        a++;
+        b++;
+      }
+    while (ca != '\0' && ca == cb);
+
+    return (uint8_t) ca - (uint8_t) cb;
+  }
+
+  template<size_t N>
+    struct static_cmd_table
+    {
+      static_cmd_t cmds[N];
+    };
+
+  /**
+   * @brief Build a table sorted by command name (insertion sort, evaluated
+   *  by the compiler).
+   * @param cmds: command descriptors, in any order.
+   * @return The sorted table.
+   */
+  template<size_t N>
+    constexpr static_cmd_table<N>
+    make_cmd_table (const static_cmd_t (&cmds)[N])
+    {
+      static_cmd_table<N> table
+        { };
+
+      for (size_t i = 0; i < N; i++)
+        {
+          size_t j = i;
+          while (j > 0
+              && cmd_name_cmp (table.cmds[j - 1].command, cmds[i].command) > 0)
+            {
+              table.cmds[j] = table.cmds[j - 1];
+              j--;
+            }
+          table.cmds[j] = cmds[i];
+        }
+
+      return table;
+    }
+
+#if SHELL_STATIC_COMMANDS == true
+  // defined by SHELL_STATIC_CMD_TABLE
+  extern const static_cmd_t* const static_cmds;
+  extern const size_t static_cmds_count;
+#endif
+
 }
 
+#define SHELL_STATIC_CMD_TABLE(...) \
+  namespace ushell \
+  { \
+    static constexpr static_cmd_t static_cmds_list_[] = { __VA_ARGS__ }; \
+    static constexpr static_cmd_table<sizeof(static_cmds_list_) \
+        / sizeof(static_cmds_list_[0])> static_cmds_table_ = \
+          make_cmd_table (static_cmds_list_); \
+    extern const static_cmd_t* const static_cmds = static_cmds_table_.cmds; \
+    extern const size_t static_cmds_count = sizeof(static_cmds_list_) \
+        / sizeof(static_cmds_list_[0]); \
+  }
+
 #endif /* __cplusplus */
 
 #endif /* INCLUDE_USHELL_H_ */
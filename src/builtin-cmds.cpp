@@ -61,6 +61,7 @@ namespace ushell
   ush_version::~ush_version ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -100,6 +101,7 @@ namespace ushell
   ush_ps::~ush_ps ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -176,6 +178,7 @@ namespace ushell
   ush_date::~ush_date ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -316,6 +319,7 @@ namespace ushell
   ush_quit::~ush_quit ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   int
@@ -342,17 +346,28 @@ namespace ushell
   ush_help::~ush_help ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   int
   ush_help::do_cmd (class ushell* ush, int argc, char* argv[])
   {
     ush->printf ("Following commands are available:\n");
-    class ushell_cmd** pclasses;
-    for (pclasses = ushell::ushell_cmds_; *pclasses != nullptr; pclasses++)
+#if SHELL_STATIC_COMMANDS == true
+    for (size_t i = 0; i < static_cmds_count; i++)
       {
-        ush->printf (" %s\t%s\n", (*pclasses)->get_cmd_info ()->command,
-                     (*pclasses)->get_cmd_info ()->help_text);
+        ush->printf (" %s\t%s\n", static_cmds[i].command,
+                     static_cmds[i].help_text);
+      }
+#endif
+    for (ushell_cmd* pclass = ushell::first_cmd (); pclass != nullptr; pclass =
+        ushell::next_cmd (pclass))
+      {
+        if (pclass->get_cmd_info ()->command != nullptr)
+          {
+            ush->printf (" %s\t%s\n", pclass->get_cmd_info ()->command,
+                         pclass->get_cmd_info ()->help_text);
+          }
       }
     ush->printf ("For help on a specific command, type \"<cmd> -h\"\n");
 
@@ -361,6 +376,312 @@ namespace ushell
 
   //----------------------------------------------------------------------------
 
+#if SHELL_PIPE_SUPPORT == true
+
+  /**
+   * @brief Constructor for the "grep" class.
+   */
+  ush_grep::ush_grep (void)
+  {
+    trace::printf ("%s() %p\n", __func__, this);
+    info_.command = "grep";
+    info_.help_text = "Print the input lines matching a pattern";
+  }
+
+  /**
+   * Destructor.
+   */
+  ush_grep::~ush_grep ()
+  {
+    trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
+  }
+
+  /**
+   * @brief Implementation of the "grep" command; it filters the output of
+   *  the previous pipeline stage.
+   * @param ush: pointer to the ushell class.
+   * @param argc: arguments count.
+   * @param argv: arguments.
+   * @return Result of the command's execution.
+   */
+  int
+  ush_grep::do_cmd (class ushell* ush, int argc, char* argv[])
+  {
+    int result = ush_ok;
+    bool icase = false, invert = false, count = false, done = false;
+
+    opt_parse getopt
+      { argc, argv };
+    int ch;
+
+    while ((ch = getopt.optparse ("hicv")) != -1)
+      {
+        switch (ch)
+          {
+          case 'h':
+            ush->printf ("Usage:\t<cmd> | %s [-i] [-v] [-c] <pattern>\n"
+                         "\t-i to ignore case, -v to print the lines not "
+                         "matching, -c to only count them\n",
+                         argv[0]);
+            done = true;
+            break;
+
+          case 'i':
+            icase = true;
+            break;
+
+          case 'v':
+            invert = true;
+            break;
+
+          case 'c':
+            count = true;
+            break;
+
+          case '?':
+            ush->printf ("%s\n", getopt.errmsg);
+            result = ush_option_invalid;
+            break;
+          }
+      }
+
+    if (result == ush_ok && !done)
+      {
+        argc -= getopt.optind;
+        argv += getopt.optind;
+
+        if (argc != 1 || !ush->piped_input ())
+          {
+            result = ush_param_invalid;
+          }
+        else
+          {
+            char line[SHELL_MAX_LINE_LEN];
+            int matches = 0;
+            bool more;
+
+            while (ush->getline (line, sizeof(line), &more) >= 0)
+              {
+                bool found = match (line, argv[0], icase);
+                bool shown = false;
+                if (more)
+                  {
+                    // longer than the buffer: printed as it comes if it is
+                    // known to be selected, else only its first part is
+                    // printed, once the rest has been searched
+                    shown = found && !invert && !count;
+                    if (shown)
+                      {
+                        ush->printf ("%s", line);
+                      }
+                    found = match_rest (ush, line, argv[0], icase, shown)
+                        || found;
+                  }
+                if (found != invert)
+                  {
+                    matches++;
+                    if (!count)
+                      {
+                        ush->printf (shown ? "\n" : "%s\n", line);
+                      }
+                  }
+              }
+            if (count)
+              {
+                ush->printf ("%d\n", matches);
+              }
+          }
+      }
+
+    return result;
+  }
+
+  /**
+   * @brief Check if a line contains a pattern (plain string).
+   * @param line: line to search.
+   * @param pattern: string to look for.
+   * @param icase: true to ignore case.
+   * @return true if found.
+   */
+  bool
+  ush_grep::match (const char* line, const char* pattern, bool icase)
+  {
+    size_t len = strlen (pattern);
+
+    for (; *line != '\0'; line++)
+      {
+        if (icase ?
+            !strncasecmp (line, pattern, len) : !strncmp (line, pattern, len))
+          {
+            return true;
+          }
+      }
+
+    return len == 0;
+  }
+
+  /**
+   * @brief Read the rest of a line longer than the buffer, searching it
+   *  for a pattern, also across the pieces it is read in.
+   * @param ush: pointer to the ushell class.
+   * @param line: first part of the line, already searched.
+   * @param pattern: string to look for.
+   * @param icase: true to ignore case.
+   * @param print: true to print the rest of the line (without the line
+   *  terminator).
+   * @return true if found in the rest of the line.
+   */
+  bool
+  ush_grep::match_rest (class ushell* ush, const char* line,
+                        const char* pattern, bool icase, bool print)
+  {
+    char buf[SHELL_MAX_LINE_LEN];
+    size_t overlap = strlen (pattern);
+    size_t keep = strlen (line);
+    bool found = false, more = true;
+    int n;
+
+    // the end of the previous piece is searched again with the next one
+    overlap = (overlap > 0) ? overlap - 1 : 0;
+    if (overlap > sizeof(buf) - 2)
+      {
+        overlap = sizeof(buf) - 2;
+      }
+    if (keep > overlap)
+      {
+        line += keep - overlap;
+        keep = overlap;
+      }
+    memcpy (buf, line, keep);
+
+    while (more && (n = ush->getline (buf + keep, sizeof(buf) - keep, &more))
+        >= 0)
+      {
+        if (print)
+          {
+            ush->write (buf + keep, n);
+          }
+        if (!found)
+          {
+            found = match (buf, pattern, icase);
+          }
+        keep += n;
+        if (keep > overlap)
+          {
+            memmove (buf, buf + keep - overlap, overlap);
+            keep = overlap;
+          }
+      }
+
+    return found;
+  }
+
+  //----------------------------------------------------------------------------
+
+  /**
+   * @brief Constructor for the "head" class.
+   */
+  ush_head::ush_head (void)
+  {
+    trace::printf ("%s() %p\n", __func__, this);
+    info_.command = "head";
+    info_.help_text = "Print the first input lines";
+  }
+
+  /**
+   * Destructor.
+   */
+  ush_head::~ush_head ()
+  {
+    trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
+  }
+
+  /**
+   * @brief Implementation of the "head" command; it passes on the first lines
+   *  of the output of the previous pipeline stage.
+   * @param ush: pointer to the ushell class.
+   * @param argc: arguments count.
+   * @param argv: arguments.
+   * @return Result of the command's execution.
+   */
+  int
+  ush_head::do_cmd (class ushell* ush, int argc, char* argv[])
+  {
+    int result = ush_ok;
+    long lines = default_lines;
+    bool done = false;
+
+    opt_parse getopt
+      { argc, argv };
+    int ch;
+
+    while ((ch = getopt.optparse ("hn:")) != -1)
+      {
+        switch (ch)
+          {
+          case 'h':
+            ush->printf ("Usage:\t<cmd> | %s [-n lines]\n", argv[0]);
+            done = true;
+            break;
+
+          case 'n':
+            {
+              char* p = getopt.optarg;
+              lines = strtol (getopt.optarg, &p, 0);
+              if (getopt.optarg == p || lines < 0)
+                {
+                  result = ush_param_invalid;  // conversion error, exit
+                }
+            }
+            break;
+
+          case '?':
+            ush->printf ("%s\n", getopt.errmsg);
+            result = ush_option_invalid;
+            break;
+          }
+      }
+
+    if (result == ush_ok && !done)
+      {
+        argc -= getopt.optind;
+
+        if (argc != 0 || !ush->piped_input ())
+          {
+            result = ush_param_invalid;
+          }
+        else
+          {
+            char line[SHELL_MAX_LINE_LEN];
+            bool more, part = false;
+
+            // a line longer than the buffer comes in pieces, it is counted
+            // once its end is read
+            while (lines > 0 && ush->getline (line, sizeof(line), &more) >= 0)
+              {
+                ush->printf (more ? "%s" : "%s\n", line);
+                part = more;
+                if (!more)
+                  {
+                    lines--;
+                  }
+              }
+            if (part)
+              {
+                ush->printf ("\n"); // the input ended in the middle of it
+              }
+          }
+      }
+
+    return result;
+  }
+
+#endif
+
+  //----------------------------------------------------------------------------
+
 #if !defined SHELL_VERSION_CMD
 #define SHELL_VERSION_CMD true
 #endif
@@ -379,6 +700,14 @@ namespace ushell
 
 #if !defined SHELL_HELP_CMD
 #define SHELL_HELP_CMD true
+#endif
+
+#if !defined SHELL_GREP_CMD
+#define SHELL_GREP_CMD SHELL_PIPE_SUPPORT
+#endif
+
+#if !defined SHELL_HEAD_CMD
+#define SHELL_HEAD_CMD SHELL_PIPE_SUPPORT
 #endif
 
   // instantiate command classes
@@ -408,6 +737,16 @@ namespace ushell
     { };
 #endif
 
+#if SHELL_PIPE_SUPPORT == true && SHELL_GREP_CMD == true
+  ush_grep grep
+    { };
+#endif
+
+#if SHELL_PIPE_SUPPORT == true && SHELL_HEAD_CMD == true
+  ush_head head
+    { };
+#endif
+
 }
 
 #pragma GCC diagnostic pop
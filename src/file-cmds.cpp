@@ -68,6 +68,7 @@ namespace ushell
   ush_ls::~ush_ls ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -149,7 +150,7 @@ namespace ushell
                 errno = 0;
                 dp = dir->read ();
 
-                if (dp == nullptr)
+                if (dp == nullptr || ush->cancelled ())
                   {
                     break;
                   }
@@ -222,6 +223,7 @@ namespace ushell
   ush_mkdir::~ush_mkdir ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -299,6 +301,7 @@ namespace ushell
   ush_cd::~ush_cd ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -381,6 +384,7 @@ namespace ushell
   ush_cp::~ush_cp ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -452,7 +456,7 @@ namespace ushell
                   }
 
                 // copy file
-                if ((copy_file (src, dst)) != 0)
+                if ((copy_file (ush, src, dst)) != 0 && !ush->cancelled ())
                   {
                     ush->printf ("File copy failed\n");
                   }
@@ -465,12 +469,13 @@ namespace ushell
 
   /**
    * @brief: Helper function for copy command.
+   * @param ush: the shell, polled for cancellation.
    * @param src_path: source file.
    * @param dst_path: destination.
    * @return 0 if succeeds, negative/positive number otherwise.
    */
   int
-  ush_cp::copy_file (char* src_path, char* dst_path)
+  ush_cp::copy_file (class ushell* ush, char* src_path, char* dst_path)
   {
     static constexpr size_t file_copy_block = 4096;
 
@@ -491,6 +496,11 @@ namespace ushell
                 // copy source to destination
                 for (;;)
                   {
+                    if (ush->cancelled ())
+                      {
+                        res = -1;
+                        break;
+                      }
                     // read a chunk of source file
                     int count = fsrc->read (buffer, file_copy_block);
                     if (count <= 0)
@@ -510,7 +520,7 @@ namespace ushell
             // close open files
             fsrc->close ();
           }
-        delete (buffer);
+        delete[] buffer;
       }
 
     return res;
@@ -534,6 +544,7 @@ namespace ushell
   ush_pwd::~ush_pwd ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -603,6 +614,7 @@ namespace ushell
   ush_rm::~ush_rm ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -659,7 +671,7 @@ namespace ushell
                 if (st_buf.st_mode & S_IFDIR)
                   {
                     // directory
-                    res = empty_dir (path, CWD_BUF_LEN);
+                    res = empty_dir (ush, path, CWD_BUF_LEN);
                     if (res == 0)
                       {
                         res = posix::rmdir (path);
@@ -671,7 +683,7 @@ namespace ushell
                     res = posix::unlink (path);
                   }
               }
-            if (res < 0)
+            if (res < 0 && !ush->cancelled ())
               {
                 ush->printf ("Could not delete file(s)\n");
               }
@@ -683,12 +695,13 @@ namespace ushell
 
   /**
    * @brief Helper function. It deletes recursively all the files in a directory.
+   * @param ush: the shell, polled for cancellation.
    * @param path: pointer to a buffer containing the directory's path.
    * @param len: length of the buffer.
    * @return 0 if successful, non-zero if it fails.
    */
   int
-  ush_rm::empty_dir (char* path, size_t len)
+  ush_rm::empty_dir (class ushell* ush, char* path, size_t len)
   {
     int res = -1;
     posix::directory* fr;
@@ -697,6 +710,8 @@ namespace ushell
 
     if ((fr = posix::opendir (path)))
       {
+        res = 0;
+
         // pointer on end of path; if path ends with no "/", then add one
         char* pp = path + strlen (path);
         if (*(pp - 1) != '/')
@@ -713,12 +728,18 @@ namespace ushell
                 *--pp = '\0';
                 break;
               }
+            if (ush->cancelled ())
+              {
+                *--pp = '\0';
+                res = -1;
+                break;
+              }
 
             strncat (path, dp->d_name, len - strlen (path));
             posix::stat (path, &st_buf);
             if (st_buf.st_mode & S_IFDIR)
               {
-                res = empty_dir (path, len);
+                res = empty_dir (ush, path, len);
                 if (res == 0)
                   {
                     res = posix::rmdir (path);
@@ -735,7 +756,10 @@ namespace ushell
             *pp = '\0';
           }
 
-        res = fr->close ();
+        if (fr->close () < 0)
+          {
+            res = -1;
+          }
       }
 
     return res;
@@ -759,6 +783,7 @@ namespace ushell
   ush_cat::~ush_cat ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -818,13 +843,16 @@ namespace ushell
                 char* buff;
                 if ((buff = new char[FILE_BUFFER]))
                   {
-                    size_t count;
+                    ssize_t count;
                     while ((count = f->read (buff, FILE_BUFFER)) > 0)
                       {
-                        ush->printf ("%.*s", count, buff);
+                        if (ush->write (buff, count) < 0 || ush->cancelled ())
+                          {
+                            break; // e.g. the next pipeline stage is done
+                          }
                       }
                     ush->printf ("\n");
-                    delete (buff);
+                    delete[] buff;
                   }
                 f->close ();
               }
@@ -852,6 +880,7 @@ namespace ushell
   ush_fdisk::~ush_fdisk ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    ushell::unlink_cmd (this);
   }
 
   /**
@@ -930,7 +959,7 @@ namespace ushell
                     uint8_t* buff = new uint8_t[bs];
                     res = fat_fs.mkfs (FM_FAT | FM_SFD, 0, 0, buff, bs);
                     fat_fs.device ().close ();
-                    delete buff;
+                    delete[] buff;
 
                     if (res >= 0)
                       {
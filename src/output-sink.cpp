@@ -0,0 +1,294 @@
+/*
+ * output-sink.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <errno.h>
+#include <string.h>
+#include <assert.h>
+#include <algorithm>
+#include <new>
+
+#include "output-sink.h"
+
+using namespace os;
+
+namespace ushell
+{
+
+  /**
+   * @brief Push any data held by the sink to its destination.
+   * @return 0 if successful, negative otherwise.
+   */
+  int
+  output_sink::flush (void)
+  {
+    return 0;
+  }
+
+  //----------------------------------------------------------------------------
+
+  /**
+   * @brief Constructor.
+   * @param tty: tty to write to.
+   */
+  tty_sink::tty_sink (posix::tty_canonical* tty) :
+      tty_
+        { tty }
+  {
+  }
+
+  /**
+   * @brief Write to the tty.
+   * @param buf: data to write.
+   * @param nbyte: number of bytes.
+   * @return Number of bytes written, negative on error.
+   */
+  ssize_t
+  tty_sink::write (const void* buf, std::size_t nbyte)
+  {
+    return tty_->write (buf, nbyte);
+  }
+
+  //----------------------------------------------------------------------------
+
+  /**
+   * @brief Constructor.
+   * @param buf: memory buffer to collect the output into.
+   * @param len: length of the buffer, including room for a terminator;
+   *  must not be zero.
+   */
+  buffer_sink::buffer_sink (char* buf, std::size_t len) :
+      buf_
+        { buf }, //
+      len_
+        { len }
+  {
+    assert(buf_ != nullptr && len_ > 0);
+    if (len_ == 0)
+      {
+        // no room even for the terminator; drop everything
+        buf_ = nullptr;
+      }
+    reset ();
+  }
+
+  /**
+   * @brief Append to the buffer; whatever does not fit is dropped.
+   * @param buf: data to write.
+   * @param nbyte: number of bytes.
+   * @return Number of bytes accepted.
+   */
+  ssize_t
+  buffer_sink::write (const void* buf, std::size_t nbyte)
+  {
+    if (buf_ == nullptr)
+      {
+        overflow_ = overflow_ || nbyte;
+        return 0;
+      }
+
+    std::size_t room = len_ - 1 - count_;
+
+    if (nbyte > room)
+      {
+        nbyte = room;
+        overflow_ = true;
+      }
+    memcpy (buf_ + count_, buf, nbyte);
+    count_ += nbyte;
+    buf_[count_] = '\0';
+
+    return nbyte;
+  }
+
+  /**
+   * @brief Discard the collected output.
+   */
+  void
+  buffer_sink::reset (void)
+  {
+    count_ = 0;
+    overflow_ = false;
+    if (buf_ != nullptr)
+      {
+        buf_[0] = '\0';
+      }
+  }
+
+  //----------------------------------------------------------------------------
+
+  /**
+   * @brief Constructor.
+   * @param file: open file to write to.
+   * @param block: size of the write-behind buffer, normally the file system's
+   *  cluster size; 0 to write through, as is also done if the buffer
+   *  cannot be allocated.
+   * @param offset: current position in the file, used to align the writes.
+   */
+  file_sink::file_sink (posix::io* file, std::size_t block, off_t offset) :
+      file_
+        { file }, //
+      block_
+        { block }, //
+      offset_
+        { offset }
+  {
+    if (block_)
+      {
+        buf_ = new (std::nothrow) char[block_];
+      }
+  }
+
+  /**
+   * @brief Destructor; the buffered data must have been flushed before.
+   */
+  file_sink::~file_sink ()
+  {
+    delete[] buf_;
+  }
+
+  /**
+   * @brief Write to the file through the write-behind buffer. Data is held
+   *  until a block boundary of the file is reached; whole blocks found in the
+   *  caller's data are written directly, without copying.
+   * @param buf: data to write.
+   * @param nbyte: number of bytes.
+   * @return Number of bytes accepted, negative on error; a short write to
+   *  the file (e.g. file system full) is an error, with errno set to ENOSPC.
+   */
+  ssize_t
+  file_sink::write (const void* buf, std::size_t nbyte)
+  {
+    if (buf_ == nullptr)
+      {
+        ssize_t r = file_->write (buf, nbyte);
+        if (r >= 0 && static_cast<std::size_t> (r) < nbyte)
+          {
+            errno = ENOSPC;
+            r = -1;
+          }
+        if (r < 0 && error_ == 0)
+          {
+            error_ = errno;
+          }
+        return r;
+      }
+
+    const char* p = static_cast<const char*> (buf);
+    std::size_t left = nbyte;
+
+    while (left)
+      {
+        // bytes up to the next block boundary
+        std::size_t limit = block_ - (offset_ + fill_) % block_;
+
+        if (fill_ == 0 && left >= limit)
+          {
+            std::size_t direct = limit + ((left - limit) / block_) * block_;
+            ssize_t r = file_->write (p, direct);
+            if (r < 0)
+              {
+                if (error_ == 0)
+                  {
+                    error_ = errno;
+                  }
+                return r;
+              }
+            if (static_cast<std::size_t> (r) < direct)
+              {
+                offset_ += r;
+                errno = ENOSPC;
+                if (error_ == 0)
+                  {
+                    error_ = errno;
+                  }
+                return -1;
+              }
+            offset_ += direct;
+            p += direct;
+            left -= direct;
+            continue;
+          }
+
+        std::size_t n = std::min (left, limit);
+        memcpy (buf_ + fill_, p, n);
+        fill_ += n;
+        p += n;
+        left -= n;
+
+        if (n == limit)
+          {
+            int r = flush ();
+            if (r < 0)
+              {
+                return r;
+              }
+          }
+      }
+
+    return nbyte;
+  }
+
+  /**
+   * @brief Write out the buffered data.
+   * @return 0 if successful, negative otherwise; errno is set to ENOSPC if
+   *  the file took only part of the data.
+   */
+  int
+  file_sink::flush (void)
+  {
+    int result = 0;
+
+    if (fill_)
+      {
+        ssize_t r = file_->write (buf_, fill_);
+        if (r < 0)
+          {
+            result = r;
+          }
+        else
+          {
+            if (static_cast<std::size_t> (r) < fill_)
+              {
+                errno = ENOSPC;
+                result = -1;
+              }
+            offset_ += r;
+          }
+        fill_ = 0;
+        if (result < 0 && error_ == 0)
+          {
+            error_ = errno;
+          }
+      }
+
+    return result;
+  }
+
+}
@@ -86,12 +86,14 @@ namespace ushell
    * @param result: if not null pointer, the result path will not replace
    *      the current path, rather will be returned at this pointer.
    * @param len: length of the result buffer.
+   * @return 0 if successful, -1 if the resulting path does not fit.
    */
-  void
+  int
   path::to_absolute (const char* path, char* result, size_t len)
   {
     char* p;
     size_t l;
+    int ret = 0;
 
     if (path == nullptr)
       {
@@ -110,6 +112,10 @@ namespace ushell
           {
             p = result;
             l = len;
+            if (strlen (path_) >= l)
+              {
+                return -1;
+              }
             strncpy (p, path_, l);
           }
 
@@ -135,13 +141,20 @@ namespace ushell
             else if (*path == '/')
               {
                 // absolute path
-                strncpy (p, path, l);
+                if (path_len >= l)
+                  {
+                    ret = -1;
+                  }
+                else
+                  {
+                    strncpy (p, path, l);
+                  }
                 break;
               }
             else
               {
                 // relative path
-                path::forward (path, p, l);
+                ret = path::forward (path, p, l);
                 break;
               }
           }
@@ -153,6 +166,8 @@ namespace ushell
     }
   trace::printf ("path_: %s\n", path_);
 #endif // PATH_DEBUG
+
+    return ret;
   }
 
   /**
@@ -201,12 +216,17 @@ namespace ushell
    * @param level: current path [in].
    * @param result: resulting path [out].
    * @param len: length of the result buffer.
+   * @return 0 if successful, -1 if the resulting path does not fit; the
+   *  result is left unchanged then.
    */
-  void
-  path::forward (const char* level, char* result,
-                 size_t len __attribute__ ((unused)))
+  int
+  path::forward (const char* level, char* result, size_t len)
   {
-    assert(strlen (result) + strlen (level) < (len - 1));
+    // room for the separator and the terminator
+    if (strlen (result) + strlen (level) + 2 > len)
+      {
+        return -1;
+      }
 
     if (result[strlen (result) - 1] != '/')
       {
@@ -219,6 +239,8 @@ namespace ushell
       {
         result[strlen (result) - 1] = '\0';
       }
+
+    return 0;
   }
 
   /**
@@ -0,0 +1,175 @@
+/*
+ * pipe.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <new>
+
+#include "ushell.h"
+
+#if SHELL_PIPE_SUPPORT == true
+
+using namespace os;
+
+namespace ushell
+{
+
+  /**
+   * @brief Constructor.
+   * @param len: capacity of the pipe in bytes, rounded up to a power of two;
+   *  the head and tail counters wrap around and are masked, not divided.
+   */
+  ring_pipe::ring_pipe (std::size_t len) :
+      len_
+        { 1 }
+  {
+    while (len_ < len)
+      {
+        len_ <<= 1;
+      }
+    buf_ = new (std::nothrow) char[len_];
+  }
+
+  /**
+   * @brief Destructor.
+   */
+  ring_pipe::~ring_pipe ()
+  {
+    delete[] buf_;
+  }
+
+  /**
+   * @brief Write to the pipe; blocks while the pipe is full.
+   * @param buf: data to write.
+   * @param nbyte: number of bytes.
+   * @return Number of bytes written, or -1 if the reader went away.
+   */
+  ssize_t
+  ring_pipe::write (const void* buf, std::size_t nbyte)
+  {
+    const char* p = static_cast<const char*> (buf);
+    std::size_t left = nbyte;
+
+    while (left)
+      {
+        if (rclosed_.load (std::memory_order_acquire))
+          {
+            return -1;  // nobody will ever read it
+          }
+
+        std::size_t head = head_.load (std::memory_order_relaxed);
+        std::size_t room = len_ - (head - tail_.load (std::memory_order_acquire));
+        if (room == 0)
+          {
+            writable_.wait ();
+            continue;
+          }
+
+        std::size_t n = std::min (left, room);
+        std::size_t pos = head & (len_ - 1);
+        std::size_t first = std::min (n, len_ - pos);
+        memcpy (buf_ + pos, p, first);
+        memcpy (buf_, p + first, n - first);
+
+        // publish the data only after it is in place
+        head_.store (head + n, std::memory_order_release);
+        readable_.post ();
+
+        p += n;
+        left -= n;
+      }
+
+    return nbyte;
+  }
+
+  /**
+   * @brief Read from the pipe; blocks while the pipe is empty.
+   * @param buf: buffer to return the data.
+   * @param nbyte: buffer length.
+   * @return Number of bytes read, 0 at end of file, i.e. when the pipe is
+   *  empty and the writer closed it.
+   */
+  ssize_t
+  ring_pipe::read (void* buf, std::size_t nbyte)
+  {
+    char* p = static_cast<char*> (buf);
+
+    while (nbyte)
+      {
+        // test for close before the data, the writer publishes in reverse
+        bool closed = wclosed_.load (std::memory_order_acquire);
+        std::size_t tail = tail_.load (std::memory_order_relaxed);
+        std::size_t avail = head_.load (std::memory_order_acquire) - tail;
+
+        if (avail)
+          {
+            std::size_t n = std::min (nbyte, avail);
+            std::size_t pos = tail & (len_ - 1);
+            std::size_t first = std::min (n, len_ - pos);
+            memcpy (p, buf_ + pos, first);
+            memcpy (p + first, buf_, n - first);
+
+            tail_.store (tail + n, std::memory_order_release);
+            writable_.post ();
+
+            return n;
+          }
+        if (closed)
+          {
+            break;
+          }
+        readable_.wait ();
+      }
+
+    return 0;
+  }
+
+  /**
+   * @brief Called by the writer when done; the reader gets an end of file
+   *  after the remaining data.
+   */
+  void
+  ring_pipe::close_write (void)
+  {
+    wclosed_.store (true, std::memory_order_release);
+    readable_.post ();
+  }
+
+  /**
+   * @brief Called by the reader when done; further writes fail.
+   */
+  void
+  ring_pipe::close_read (void)
+  {
+    rclosed_.store (true, std::memory_order_release);
+    writable_.post ();
+  }
+
+}
+
+#endif /* SHELL_PIPE_SUPPORT == true */
@@ -59,10 +59,15 @@
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 #include <cmsis-plus/posix/termios.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <new>
 
 #include "readline.h"
 
 #if SHELL_FILE_SUPPORT == true
+#include <cmsis-plus/posix-io/file-system.h>
 #include <fcntl.h>
 #endif
 
@@ -78,6 +83,70 @@ using namespace os;
 namespace ushell
 {
 
+  constexpr read_line::rl_command_t read_line::rl_commands[];
+  constexpr char read_line::paste_stop[];
+
+  /**
+   * @brief Build the trie of the command sequences, as its transition
+   *  table.
+   * @return The trie; node 0 is the root.
+   */
+  constexpr read_line::rl_trie_t
+  read_line::make_trie (void)
+  {
+    rl_trie_t t
+      { };
+
+    // number the bytes used
+    std::size_t cols = 1;
+    for (std::size_t i = 0; i < countof(rl_commands); i++)
+      {
+        const char* p = rl_commands[i].seq;
+        if (static_cast<uint8_t> (*p) >= ' ' && *p != '\x7F')
+          {
+            t.printable = true; // text is not dispatched, never reached
+          }
+        for (; *p != '\0'; p++)
+          {
+            if (t.col[static_cast<uint8_t> (*p)] == 0)
+              {
+                t.col[static_cast<uint8_t> (*p)] = cols++;
+              }
+          }
+      }
+
+    std::size_t len = 1;
+    for (std::size_t i = 0; i < countof(rl_commands); i++)
+      {
+        std::size_t n = 0;
+        for (const char* p = rl_commands[i].seq; *p != '\0'; p++)
+          {
+            uint8_t& c = t.next[n][t.col[static_cast<uint8_t> (*p)]];
+            if (p[1] == '\0')
+              {
+                if (c != 0)
+                  {
+                    t.ambiguous = true; // a prefix of another, or twice
+                  }
+                c = rl_trie_len + i;
+              }
+            else if (c == 0)
+              {
+                c = len++;
+              }
+            else if (c >= rl_trie_len)
+              {
+                t.ambiguous = true; // it would never be reached
+                break;
+              }
+            n = c;
+          }
+      }
+    return t;
+  }
+
+  constexpr read_line::rl_trie_t read_line::rl_trie_ = make_trie ();
+
   read_line::read_line (rl_get_completion_fn gc, char* history, size_t len) :
       get_completion_
         { gc }, //
@@ -93,6 +162,10 @@ namespace ushell
   read_line::read_line (rl_get_completion_fn gc, const char* file) :
       get_completion_
         { gc }, //
+      history_
+        { nullptr }, //
+      hist_len_
+        { SHELL_FILE_HISTORY_LEN }, //
       file_
         { file }
   {
@@ -102,74 +175,100 @@ namespace ushell
   read_line::~read_line ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+#if SHELL_FILE_SUPPORT == true
+    if (file_)
+      {
+        // allocated by initialise (), the memory history is the caller's
+        delete[] history_;
+        delete[] jbuf_;
+        delete[] jtmp_;
+      }
+#endif
   }
 
   void
   read_line::initialise (os::posix::tty_canonical* tty)
   {
     tty_ = tty;
+    in_pos_ = in_len_ = 0;
+    paste_ = paste_cr_ = false;
+
+    // bracketed paste, for the whole session
+    out (paste_on, strlen (paste_on));
+    flush ();
 
 #if SHELL_FILE_SUPPORT == true
     if (file_)
       {
-        bool result = false;
-        struct stat st;
-        int res = posix::stat (file_, &st);
-        if (res == 0 && st.st_size)
+        // the history is kept in memory and rebuilt from the journal; the
+        // buffers are allocated by the first session and kept
+        if (history_ == nullptr)
           {
-            posix::io* f = posix::open (file_, O_RDONLY);
-            if (f)
+            size_t len = strlen (file_);
+            history_ = new (std::nothrow) char[hist_len_];
+            jbuf_ = new (std::nothrow) char[SHELL_HISTORY_BLOCK_LEN];
+            jtmp_ = new (std::nothrow) char[len + 2];
+            if (history_ == nullptr || jbuf_ == nullptr || jtmp_ == nullptr)
               {
-                history_ = new char[st.st_size];
-                assert(history_);
-                hist_len_ = st.st_size - 2;
-                if (f->read (history_, st.st_size))
-                  {
-                    result = true;
-                  }
-                f->close ();
+                // no memory: lines are still edited, without a history
+                // and without the journal
+                trace::printf ("%s() no memory for the history\n",
+                               __func__);
+                delete[] history_;
+                delete[] jbuf_;
+                delete[] jtmp_;
+                history_ = jbuf_ = jtmp_ = nullptr;
+                file_ = nullptr;
+                hl_.newest = hist_none;
+                current_ = hist_none;
+                return;
               }
+            memcpy (jtmp_, file_, len);
+            memcpy (jtmp_ + len, "~", 2);
           }
-        if (!result)
-          {
-            // history file not found or read failed
-            history_ = new char[SHELL_FILE_HISTORY_LEN];
-            assert(history_);
-            hist_len_ = SHELL_FILE_HISTORY_LEN - 2;
-          }
+        memset (history_, 0, hist_len_);
+      }
+    else if (history_ == nullptr)
+      {
+        return; // disabled by a previous session
       }
 #endif
 
     assert(history_);
-    assert(hist_len_);
+    assert(hist_len_ > sizeof(hl_t) && hist_len_ < hist_none);
 
-    // check if the history is consistent
-    uint16_t sum = 0;
-    for (size_t i = 0; i < hist_len_; i++)
+    if (!history_valid ())
       {
-        sum += history_[i];
+        history_reset ();
       }
-    uint16_t have = history_[hist_len_] & 0xFF;
-    have += ((history_[hist_len_ + 1] & 0xFF) << 8);
-    if (sum != have)
-      {
-        // inconsistent, initialise the history; first add an empty entry
-        hh_t hh;
+    current_ = hist_none;
 
-        hh.prev = 0;
-        hh.next = sizeof(hh_t) + 1;
-        memcpy (history_, &hh, sizeof(hh_t));
-        history_[sizeof(hh_t)] = '\0';
-
-        // add behind the empty entry an "end of history" entry
-        hh.next = 0;
-        memcpy (history_ + sizeof(hh_t) + 1, &hh, sizeof(hh_t));
+#if SHELL_FILE_SUPPORT == true
+    if (file_)
+      {
+        jstale_ = !journal_replay () && !journal_compact ();
       }
-    current_ = history_;
+#endif
   }
 
+  /**
+   * @brief Read and edit a line. The tty should be set up for blocking
+   *  reads (VMIN = 1, VTIME = 0); the input is only waited for with a
+   *  timeout while an escape sequence is incomplete, so that a lone ESC
+   *  can be told apart, or while the idle timeout or a history sync is
+   *  pending. Input is read in chunks; runs of text, including bracketed
+   *  pastes, are inserted at once. Bytes read past the end of the line are
+   *  kept for the next call.
+   * @param prompt: prompt to be displayed.
+   * @param buff: buffer for the line.
+   * @param len: buffer length.
+   * @param timeout: seconds without input before giving up, 0 for none.
+   * @return Length of the line, or -1 with errno set to ETIMEDOUT if the
+   *  timeout expired, or -1 if the tty failed.
+   */
   int
-  read_line::readline (const char* prompt, void* buff, size_t len)
+  read_line::readline (const char* prompt, void* buff, size_t len,
+                       unsigned int timeout)
   {
     const char nl[] =
       { "\n" };
@@ -184,28 +283,125 @@ namespace ushell
 
     out (prompt, strlen (prompt));
 
-    char ch, seq[12], * seqpos = seq;
-    while (tty_->read (&ch, 1) > 0)
+    // a paste goes on across lines
+    seq_len_ = node_ = 0;
+    skip_ = false;
+
+    ssize_t n = 0;
+    bool more = false;
+    rtos::clock::timestamp_t idle = rtos::sysclock.now ();
+    while (!finish_)
       {
-        if (seqpos >= seq + sizeof(seq))
+        if (in_pos_ == in_len_ || more)
           {
-            seqpos = seq; // wrong sequence -- wrong reaction :)
-          }
-        *seqpos++ = ch;
-        *seqpos = 0;
-        if (!skip_char_seq (seq))
-          {
-            continue;   // wrong seq
-          }
-        if (exec_seq (seq))
-          {
-            break;      // finish
+            // keep what is left, read as much as is available after it
+            if (in_pos_)
+              {
+                memmove (in_, in_ + in_pos_, in_len_ - in_pos_);
+                in_len_ -= in_pos_;
+                in_pos_ = 0;
+              }
+            flush ();
+
+            // idle, block, unless a timer is running
+            rtos::clock::duration_t wait = 0;
+            rtos::clock::duration_t quiet = rtos::sysclock.now () - idle;
+            if (seq_len_ || in_len_)
+              {
+                wait = SHELL_ESC_TIMEOUT * rtos::sysclock.frequency_hz / 1000;
+                wait = wait ? wait : 1;
+              }
+            else
+              {
+#if SHELL_FILE_SUPPORT == true
+                rtos::clock::duration_t sync = SHELL_HISTORY_SYNC_TIME
+                    * rtos::sysclock.frequency_hz;
+                if (jlen_)
+                  {
+                    wait = quiet < sync ? sync - quiet : 1;
+                  }
+#endif
+                if (timeout)
+                  {
+                    rtos::clock::duration_t limit = timeout
+                        * rtos::sysclock.frequency_hz;
+                    rtos::clock::duration_t left =
+                        quiet < limit ? limit - quiet : 1;
+                    if (wait == 0 || left < wait)
+                      {
+                        wait = left;
+                      }
+                  }
+              }
+
+            n = wait ? tty_->wait_input (wait) : 1;
+            if (n > 0)
+              {
+                n = tty_->read (in_ + in_len_, sizeof(in_) - in_len_);
+              }
+            if (n < 0)
+              {
+                break;
+              }
+            if (tty_->clear_interrupt ())
+              {
+                // ctrl-c, taken out of the input by the tty (ISIG); as
+                // without ISIG, it drops the line being edited, and with it
+                // the rest of the input read so far
+                seq_len_ = node_ = in_len_ = 0;
+                skip_ = false;
+                cancel (this);
+                idle = rtos::sysclock.now ();
+                continue;
+              }
+            if (n == 0)
+              {
+                if (seq_len_ || in_len_)
+                  {
+                    // the rest of the sequence did not follow, drop it;
+                    // this is how a lone ESC is told apart from an escape
+                    // sequence
+                    seq_len_ = node_ = in_len_ = 0;
+                    skip_ = false;
+                  }
+                else
+                  {
+#if SHELL_FILE_SUPPORT == true
+                    if (jlen_
+                        && rtos::sysclock.now () - idle
+                            >= SHELL_HISTORY_SYNC_TIME
+                                * rtos::sysclock.frequency_hz
+                        && rlmx_.lock () == rtos::result::ok)
+                      {
+                        journal_flush ();
+                        rlmx_.unlock ();
+                      }
+#endif
+                    if (timeout
+                        && rtos::sysclock.now () - idle
+                            >= timeout * rtos::sysclock.frequency_hz)
+                      {
+                        flush ();
+                        errno = ETIMEDOUT;
+                        return -1;
+                      }
+                  }
+                continue;
+              }
+            in_len_ += n;
+            idle = rtos::sysclock.now ();
           }
-        seqpos = seq;
+        more = !process_input ();
+      }
+    if (n < 0)
+      {
+        flush ();
+        return -1;
       }
 
     cursor_end (this);
     out (nl, strlen (nl));
+    flush ();
 #if SHELL_UTF8_SUPPORT == true
     gtoutf8 (raw_, line_, -1);
 #endif
@@ -216,68 +412,492 @@ namespace ushell
   void
   read_line::end (void)
   {
+    out (paste_off, strlen (paste_off));
+    flush ();
+
 #if SHELL_FILE_SUPPORT == true
-    if (file_)
+    if (file_ && rlmx_.lock () == rtos::result::ok)
       {
-        posix::io* f = posix::open (file_, O_WRONLY | O_CREAT);
-        if (f)
-          {
-            f->write (history_, hist_len_ + 2);
-            f->close ();
-          }
+        journal_flush ();
+        rlmx_.unlock ();
       }
 #endif
   }
 
   //----------------------------------------------------------------------------
 
-  void
-  read_line::history_add (const char* string)
+  /**
+   * @brief Check the history: the log header, then the records from the
+   *  newest back; at the first one found corrupt, it and all older ones are
+   *  dropped. On success the state is loaded.
+   * @return true if the history can be used, false otherwise.
+   */
+  bool
+  read_line::history_valid (void)
   {
-    if (*string)
+    hl_t hl;
+    memcpy (&hl, history_, sizeof(hl_t));
+    if (hl.magic != hist_magic || hl.version != hist_version
+        || hl.crc != crc16 (0xFFFF, &hl, offsetof(hl_t, crc))
+        || hl.head < sizeof(hl_t) || hl.head > hist_len_
+        || hl.tail < sizeof(hl_t) || hl.tail >= hist_len_
+        || (hl.newest != hist_none
+            && (hl.newest < sizeof(hl_t) || hl.newest >= hist_len_)))
       {
+        return false;
+      }
+    hl_ = hl;
+
+    int rec = hl_.newest;
+    int good = hist_none;
+    for (size_t n = 0; rec != hist_none && n < hist_len_; n++)
+      {
+        if (!history_check (rec))
+          {
+            break;
+          }
+        good = rec;
+        if (rec == hl_.tail)
+          {
+            break;
+          }
         hh_t hh;
-        char* p = history_ + sizeof(hh_t) + 1; // skip the empty entry
+        memcpy (&hh, history_ + rec, sizeof(hh_t));
+        rec = hh.prev;
+      }
+    if (good != hl_.tail)
+      {
+        // salvage what is good
+        if (good == hist_none)
+          {
+            hl_.newest = hist_none;
+            hl_.tail = hl_.head;
+          }
+        else
+          {
+            hl_.tail = good;
+          }
+        history_save ();
+      }
+    return true;
+  }
 
+  /**
+   * @brief Check a history record: its place, length and CRC.
+   * @param rec: offset of the record.
+   * @return true if the record is sound, false otherwise.
+   */
+  bool
+  read_line::history_check (int rec)
+  {
+    hh_t hh;
+
+    if (rec < (int) sizeof(hl_t) || rec + sizeof(hh_t) > hist_len_)
+      {
+        return false;
+      }
+    memcpy (&hh, history_ + rec, sizeof(hh_t));
+    const char* text = history_ + rec + sizeof(hh_t);
+    if (hh.len == 0 || rec + sizeof(hh_t) + hh.len > hist_len_
+        || text[hh.len - 1] != '\0')
+      {
+        return false;
+      }
+    uint16_t crc = crc16 (0xFFFF, &hh, offsetof(hh_t, crc));
+    return hh.crc == crc16 (crc, text, hh.len);
+  }
+
+  /**
+   * @brief Update a CRC-16/CCITT with a block of data.
+   * @param crc: CRC so far, 0xFFFF to start with.
+   * @param data: pointer to the data.
+   * @param len: length of the data.
+   * @return The new CRC.
+   */
+  uint16_t
+  read_line::crc16 (uint16_t crc, const void* data, size_t len)
+  {
+    const uint8_t* p = (const uint8_t*) data;
+
+    while (len--)
+      {
+        crc ^= (uint16_t) (*p++ << 8);
+        for (int i = 0; i < 8; i++)
+          {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+          }
+      }
+    return crc;
+  }
+
+  /**
+   * @brief Start an empty history, in the current format.
+   */
+  void
+  read_line::history_reset (void)
+  {
+    hl_.magic = hist_magic;
+    hl_.version = hist_version;
+    hl_.head = hl_.tail = sizeof(hl_t);
+    hl_.newest = hist_none;
+    history_save ();
+  }
+
+  /**
+   * @brief Add a line to the history, unless it repeats the last one; with
+   *  a history file, it is also queued for the journal.
+   * @param string: the line.
+   */
+  void
+  read_line::history_add (const char* string)
+  {
+    if (*string && history_ != nullptr)
+      {
         if (rlmx_.lock () == rtos::result::ok)
           {
-            memcpy (&hh, p, sizeof(hh_t));
-            if (strncmp (p + sizeof(hh_t), string, strlen (string)))
+#if SHELL_FILE_SUPPORT == true
+            if (history_put (string) && file_)
               {
-                // +1 = null terminator
-                size_t rec_len = sizeof(hh_t) + strlen (string) + 1;
-                hh.prev = rec_len;
-                memcpy (p, &hh, sizeof(hh_t));
-
-                // shift memory up to make space for the new entry
-                memmove (p + rec_len, p,
-                         hist_len_ - (rec_len + sizeof(hh_t) + 1));
-
-                hh.prev = sizeof(hh_t) + 1;
-                hh.next = rec_len;
-                memcpy (p, &hh, sizeof(hh_t));
-                memcpy (p + sizeof(hh_t), string, strlen (string));
-                p[rec_len - 1] = '\0'; // insert null terminator
-
-                // calculate the new checksum
-                uint16_t sum = 0;
-                for (size_t i = 0; i < hist_len_; i++)
+                journal_append (string, strlen (string) + 1);
+#if SHELL_HISTORY_SYNC_TIME == 0
+                journal_flush ();
+#endif
+              }
+#else
+            history_put (string);
+#endif
+            current_ = hist_none;       // reset history pointer
+            rlmx_.unlock ();
+          }
+      }
+  }
+
+  /**
+   * @brief Put a line in the history log, unless it repeats the last one;
+   *  the oldest records make room for it, if needed.
+   * @param string: the line.
+   * @return true if the line was added, false otherwise.
+   */
+  bool
+  read_line::history_put (const char* string)
+  {
+    size_t len = strlen (string) + 1;
+    int size = sizeof(hh_t) + len;
+
+    if ((hl_.newest == hist_none
+        || strcmp (history_ + hl_.newest + sizeof(hh_t), string))
+        && size <= (int) (hist_len_ - sizeof(hl_t)))
+      {
+        int from = hl_.head;
+        int to = from + size;
+        bool wrap = to > (int) hist_len_;
+
+        if (wrap)
+          {
+            to = hist_len_;
+          }
+        while (true)
+          {
+            // evict the records in the way
+            while (hl_.newest != hist_none && hl_.tail >= from
+                && hl_.tail < to)
+              {
+                if (hl_.tail == hl_.newest)
+                  {
+                    hl_.newest = hist_none;
+                  }
+                else
                   {
-                    sum += history_[i];
+                    hl_.tail = history_next (hl_.tail);
                   }
-                history_[hist_len_] = sum & 0xFF;
-                history_[hist_len_ + 1] = (sum >> 8) & 0xFF;
               }
-            current_ = history_;        // reset history pointer
-            rlmx_.unlock ();
+            if (!wrap)
+              {
+                break;
+              }
+            // no room up to the end, mark the wrap and go to the start
+            if (from + sizeof(hh_t) <= hist_len_)
+              {
+                hh_t hh =
+                  { 0, 0, 0 };
+                memcpy (history_ + from, &hh, sizeof(hh_t));
+              }
+            from = sizeof(hl_t);
+            to = from + size;
+            wrap = false;
+          }
+
+        hh_t hh;
+        hh.len = len;
+        hh.prev = hl_.newest;
+        hh.crc = crc16 (crc16 (0xFFFF, &hh, offsetof(hh_t, crc)),
+                        string, len);
+        memcpy (history_ + from, &hh, sizeof(hh_t));
+        memcpy (history_ + from + sizeof(hh_t), string, len);
+
+        if (hl_.newest == hist_none)
+          {
+            hl_.tail = from;
+          }
+        hl_.newest = from;
+        hl_.head = from + size;
+        history_save ();
+        return true;
+      }
+    return false;
+  }
+
+  /**
+   * @brief Get the record following (newer than) a record.
+   * @param rec: offset of a record, other than the newest.
+   * @return Offset of the next record.
+   */
+  int
+  read_line::history_next (int rec)
+  {
+    hh_t hh;
+
+    memcpy (&hh, history_ + rec, sizeof(hh_t));
+    rec += sizeof(hh_t) + hh.len;
+    if (rec + sizeof(hh_t) > hist_len_)
+      {
+        return sizeof(hl_t);
+      }
+    memcpy (&hh, history_ + rec, sizeof(hh_t));
+    return hh.len ? rec : sizeof(hl_t);
+  }
+
+  /**
+   * @brief Store the state of the log in the history.
+   */
+  void
+  read_line::history_save (void)
+  {
+    hl_.crc = crc16 (0xFFFF, &hl_, offsetof(hl_t, crc));
+    memcpy (history_, &hl_, sizeof(hl_t));
+  }
+
+  /**
+   * @brief Show a history record on the line.
+   * @param rec: offset of the record, or hist_none for an empty line.
+   */
+  void
+  read_line::history_show (int rec)
+  {
+    current_ = rec;
+    set_text (rec == hist_none ? "" : history_ + rec + sizeof(hh_t), 1);
+  }
+
+#if SHELL_FILE_SUPPORT == true
+
+  /**
+   * @brief Rebuild the history from the journal. A record cut short, e.g.
+   *  by a reset while it was written, ends the replay.
+   * @return true if the journal was read to its end and needs no
+   *  compaction, false otherwise.
+   */
+  bool
+  read_line::journal_replay (void)
+  {
+    struct stat st;
+    if (posix::stat (file_, &st) != 0 && posix::stat (jtmp_, &st) == 0)
+      {
+        // a compaction was interrupted after the old journal was removed
+        posix::rename (jtmp_, file_);
+      }
+
+    posix::io* f = posix::open (file_, O_RDONLY);
+    if (f == nullptr)
+      {
+        return false;
+      }
+
+    bool clean = false;
+    uint8_t hdr[2];
+    if (f->read (hdr, sizeof(hdr)) == sizeof(hdr) && hdr[0] == journal_magic
+        && hdr[1] == journal_version)
+      {
+        char text[SHELL_MAX_LINE_LEN];
+        jh_t jh;
+        ssize_t n;
+
+        jsize_ = sizeof(hdr);
+        while ((n = f->read (&jh, sizeof(jh_t))) == sizeof(jh_t))
+          {
+            if (jh.len == 0 || jh.len > sizeof(text)
+                || f->read (text, jh.len) != (ssize_t) jh.len
+                || text[jh.len - 1] != '\0'
+                || jh.crc
+                    != crc16 (crc16 (0xFFFF, &jh, offsetof(jh_t, crc)), text,
+                              jh.len))
+              {
+                break;
+              }
+            history_put (text);
+            jsize_ += sizeof(jh_t) + jh.len;
           }
+        clean = (n == 0);
       }
+    f->close ();
+
+    return clean && jsize_ <= SHELL_HISTORY_JOURNAL_LEN;
   }
 
+  /**
+   * @brief Queue an entry for the journal; the queue is written when the
+   *  next entry would not fit in a block.
+   * @param string: the entry.
+   * @param len: its length, terminator included.
+   */
+  void
+  read_line::journal_append (const char* string, size_t len)
+  {
+    static_assert(SHELL_HISTORY_BLOCK_LEN >= SHELL_MAX_LINE_LEN + sizeof(jh_t),
+        "a history file block must hold the longest line");
+
+    if (jlen_ + sizeof(jh_t) + len > SHELL_HISTORY_BLOCK_LEN)
+      {
+        journal_flush ();
+      }
+
+    jh_t jh;
+    jh.len = len;
+    jh.crc = crc16 (crc16 (0xFFFF, &jh, offsetof(jh_t, crc)), string, len);
+    memcpy (jbuf_ + jlen_, &jh, sizeof(jh_t));
+    memcpy (jbuf_ + jlen_ + sizeof(jh_t), string, len);
+    jlen_ += sizeof(jh_t) + len;
+  }
+
+  /**
+   * @brief Append the queued entries to the journal. The journal is
+   *  compacted instead if it would grow too big, if it is gone or was
+   *  never written, or if entries are missing from it; the entries are
+   *  then written from the history, and if that fails too, the next flush
+   *  tries again.
+   */
+  void
+  read_line::journal_flush (void)
+  {
+    if (jlen_ == 0 && !jstale_)
+      {
+        return;
+      }
+
+    posix::io* f = nullptr;
+    if (!jstale_ && jsize_ != 0 && jsize_ + jlen_ <= SHELL_HISTORY_JOURNAL_LEN)
+      {
+        // only to a journal with its header
+        f = posix::open (file_, O_WRONLY | O_APPEND);
+      }
+    if (f == nullptr)
+      {
+        jstale_ = !journal_compact ();
+        jlen_ = 0; // in the history anyway
+        return;
+      }
+
+    if (f->write (jbuf_, jlen_) == (ssize_t) jlen_)
+      {
+        jsize_ += jlen_;
+      }
+    else
+      {
+        jstale_ = true; // maybe a torn entry, the replay would stop there
+      }
+    f->close ();
+    jlen_ = 0;
+  }
+
+  /**
+   * @brief Write the journal anew from the history, to a temporary file
+   *  which then replaces it.
+   * @return true if successful, false otherwise.
+   */
+  bool
+  read_line::journal_compact (void)
+  {
+    bool result = false;
+    posix::io* f = posix::open (jtmp_, O_WRONLY | O_CREAT | O_TRUNC);
+    if (f)
+      {
+        size_t size = 0;
+
+        jlen_ = 0;
+        jbuf_[jlen_++] = journal_magic;
+        jbuf_[jlen_++] = journal_version;
+        result = true;
+        for (int rec = hl_.tail; hl_.newest != hist_none && result;
+            rec = history_next (rec))
+          {
+            hh_t hh;
+            memcpy (&hh, history_ + rec, sizeof(hh_t));
+            if (jlen_ + sizeof(jh_t) + hh.len > SHELL_HISTORY_BLOCK_LEN)
+              {
+                result = (f->write (jbuf_, jlen_) == (ssize_t) jlen_);
+                size += jlen_;
+                jlen_ = 0;
+              }
+            journal_append (history_ + rec + sizeof(hh_t), hh.len);
+            if (rec == hl_.newest)
+              {
+                break;
+              }
+          }
+        if (result)
+          {
+            result = (f->write (jbuf_, jlen_) == (ssize_t) jlen_);
+            size += jlen_;
+          }
+        jlen_ = 0;
+        f->close ();
+
+        if (result)
+          {
+            posix::unlink (file_);
+            result = (posix::rename (jtmp_, file_) == 0);
+            jsize_ = size;
+          }
+      }
+
+    return result;
+  }
+
+#endif
+
+  /**
+   * @brief Queue output in the render buffer; it goes to the tty when full
+   *  or when flushed.
+   * @param data: pointer to the data.
+   * @param size: size of the data.
+   * @return The size of the data.
+   */
   int
   read_line::out (const char* data, int size)
   {
-    return tty_->write (data, size);
+    if (rlen_ + size > (int) sizeof(rbuf_))
+      {
+        flush ();
+        if (size > (int) sizeof(rbuf_))
+          {
+            return tty_->write (data, size);
+          }
+      }
+    memcpy (rbuf_ + rlen_, data, size);
+    rlen_ += size;
+    return size;
+  }
+
+  /**
+   * @brief Write the render buffer to the tty.
+   */
+  void
+  read_line::flush (void)
+  {
+    if (rlen_)
+      {
+        tty_->write (rbuf_, rlen_);
+        rlen_ = 0;
+      }
   }
 
   read_line::rl_glyph_t
@@ -439,34 +1059,54 @@ namespace ushell
     return 0; // not closed sequence
   }
 
+  /**
+   * @brief Move the cursor on the line, by backspaces or by writing the
+   *  text over, or by an ANSI cursor sequence where that is shorter.
+   * @param count: number of columns, negative to the left.
+   */
   void
   read_line::move (int count)
   {
+    char esc[12];
+
     if (count < 0)
       {
-        while (count++)
+        int n = snprintf (esc, sizeof(esc), "\033[%dD", -count);
+        if (n < -count)
+          {
+            out (esc, n);
+          }
+        else
           {
-            out (bs, strlen (bs));
+            while (count++)
+              {
+                out (bs, strlen (bs));
+              }
           }
       }
     else if (count > 0)
       {
 #if SHELL_UTF8_SUPPORT == true
-        char buf[4];
-        rl_glyph_t* gl = line_ + cur_pos_;
-
-        while (count-- && *gl)
+        int len = 0, bytes = 0;
+        for (rl_glyph_t* gl = line_ + cur_pos_; len < count && *gl; gl++)
           {
-            int n = one_gtoutf8 (buf, *gl++);
-            if (n)
-              {
-                out (buf, n);
-              }
+            char buf[4];
+            bytes += one_gtoutf8 (buf, *gl);
+            len++;
           }
 #else
-          count = std::min (count, (int) strlen (raw_ + cur_pos_));
-          out (raw_ + cur_pos_, count);
+          int len = std::min (count, (int) strlen (raw_ + cur_pos_));
+          int bytes = len;
 #endif
+        int n = snprintf (esc, sizeof(esc), "\033[%dC", len);
+        if (n < bytes)
+          {
+            out (esc, n);
+          }
+        else
+          {
+            write_part (cur_pos_, len);
+          }
       }
     return;
   }
@@ -538,34 +1178,62 @@ namespace ushell
 #endif
   }
 
+  /**
+   * @brief Replace the text of the line, leaving the cursor at its end.
+   *  When redrawn, only what differs from the displayed text is written.
+   * @param text: the new text.
+   * @param redraw: if not zero, update the display too.
+   */
   void
   read_line::set_text (const char* text, int redraw)
   {
+    int oldlen = length_;
+
     if (redraw)
       {
-        cursor_home (this);
+        // find the common prefix and go there, while the old text is in place
+        int same = 0;
+#if SHELL_UTF8_SUPPORT == true
+        const char* raw = text;
+        while (same < oldlen && *raw)
+          {
+            rl_glyph_t gl = utf8_to_glyph (&raw);
+            if (gl == 0 || gl != line_[same] || raw - text >= (int) raw_len_)
+              {
+                break;
+              }
+            same++;
+          }
+#else
+          while (same < oldlen && same < (int) raw_len_ - 1
+              && text[same] == raw_[same])
+            {
+              same++;
+            }
+#endif
+        move (same - cur_pos_);
+        cur_pos_ = same;
       }
 
-    int oldlen = length_;
-
     strncpy (raw_, text, std::min (strlen (text) + 1, raw_len_ - 1));
     raw_[raw_len_ - 1] = '\0'; // make sure we have a terminator
 #if SHELL_UTF8_SUPPORT == true
     rl_glyph_t* end = utf8tog (line_, raw_);
     *end = '\0';
-    length_ = cur_pos_ = end - line_;
+    length_ = end - line_;
 #else
-      length_ = cur_pos_ = strlen (text);
+      length_ = strlen (raw_);
 #endif
 
     if (redraw)
       {
-        write_part (0, length_);
+        write_part (cur_pos_, length_ - cur_pos_);
         if (oldlen > length_)
           {
-            update_tail (oldlen - length_);
+            out (erase_eol, strlen (erase_eol));
           }
       }
+    cur_pos_ = length_;
   }
 
   void
@@ -584,7 +1252,21 @@ namespace ushell
             memmove (line_ + cur_pos_ + count, line_ + cur_pos_,
                      sizeof(rl_glyph_t) * (length_ - cur_pos_));
           }
-        utf8tog (line_ + cur_pos_, seq);
+        // convert no more than what fits
+        rl_glyph_t* gp = line_ + cur_pos_;
+        for (int i = 0; i < count && *seq;)
+          {
+            rl_glyph_t gl = utf8_to_glyph (&seq);
+            if (gl)
+              {
+                *gp++ = gl;
+                i++;
+              }
+            else
+              {
+                ++seq;      // skip a char of wrong utf8 sequence
+              }
+          }
         length_ += count;
         line_[length_] = 0;
       }
@@ -601,7 +1283,7 @@ namespace ushell
               memmove (raw_ + cur_pos_ + count, raw_ + cur_pos_,
                   (length_ - cur_pos_));
             }
-          memcpy (raw_ + cur_pos_, seq, strlen (seq));
+          memcpy (raw_ + cur_pos_, seq, count);
           length_ += count;
           raw_[length_] = 0;
         }
@@ -611,28 +1293,201 @@ namespace ushell
     update_tail (0);
   }
 
+  /**
+   * @brief Advance in the trie of the command sequences; one table lookup.
+   * @param node: current node, 0 at the start of a sequence.
+   * @param ch: received byte.
+   * @return The next node, the command completed numbered after the
+   *  nodes, or 0 if no sequence continues with this byte.
+   */
+  int
+  read_line::trie_step (int node, char ch)
+  {
+    static_assert(rl_trie_len + countof(rl_commands) < 256,
+        "rl_trie_t nodes and commands are 8-bit");
+    static_assert(!rl_trie_.ambiguous,
+        "a sequence in rl_commands is the prefix of another one");
+    static_assert(!rl_trie_.printable,
+        "a sequence in rl_commands starts with a printable character");
+    static_assert(rl_trie_cols < 256, "rl_trie_t columns are 8-bit");
+
+    return rl_trie_.next[node][rl_trie_.col[static_cast<uint8_t> (ch)]];
+  }
+
+  /**
+   * @brief Process the bytes read from the tty: runs of text are inserted
+   *  in one go, with one redraw, the rest goes through the key bindings;
+   *  in a bracketed paste, key bindings are not used at all and each line
+   *  end finishes the line, the rest of the paste is left for the next.
+   * @return false if more bytes are needed to go on, true otherwise.
+   */
   bool
-  read_line::exec_seq (char* seq)
+  read_line::process_input (void)
   {
-    const rl_command_t* cmd = rl_commands, * end = rl_commands
-        + countof(rl_commands);
+    while (in_pos_ < in_len_ && !finish_)
+      {
+        const char* p = in_ + in_pos_;
+        size_t avail = in_len_ - in_pos_;
 
-    while (cmd < end)
+        if (seq_len_ == 0)
+          {
+            size_t k = text_run (p, avail);
+            if (k)
+              {
+                insert_run (p, k);
+                in_pos_ += k;
+                paste_cr_ = false;
+                continue;
+              }
+          }
+        if (paste_)
+          {
+            if (*p == '\r' || *p == '\n')
+              {
+                // a LF right after a CR ends the same line
+                if (!(*p == '\n' && paste_cr_))
+                  {
+                    finish_ = true;
+                  }
+                paste_cr_ = (*p == '\r');
+                in_pos_++;
+                continue;
+              }
+            paste_cr_ = false;
+            if (*p == '\033')
+              {
+                size_t k = std::min (avail, sizeof(paste_stop) - 1);
+                if (memcmp (p, paste_stop, k) == 0)
+                  {
+                    if (k < sizeof(paste_stop) - 1)
+                      {
+                        return false; // wait for the rest of the marker
+                      }
+                    paste_ = false;
+                    in_pos_ += k;
+                    continue;
+                  }
+              }
+            else if (*p & 0x80)
+              {
+                return false; // a glyph cut short, wait for the rest
+              }
+            in_pos_++; // other control characters are dropped
+            continue;
+          }
+        dispatch (in_[in_pos_++]);
+      }
+    return true;
+  }
+
+  /**
+   * @brief Feed a byte to the key bindings; anything not bound is inserted,
+   *  if printable, once its glyph is complete.
+   * @param ch: received byte.
+   */
+  void
+  read_line::dispatch (char ch)
+  {
+    if (seq_len_ >= sizeof(seq_) - 1)
+      {
+        seq_len_ = node_ = 0; // wrong sequence -- wrong reaction :)
+        skip_ = false;
+      }
+    seq_[seq_len_++] = ch;
+    seq_[seq_len_] = 0;
+
+    if (!skip_)
+      {
+        int next = trie_step (node_, ch);
+        if (next)
+          {
+            if (next < static_cast<int> (rl_trie_len))
+              {
+                node_ = next; // a prefix, wait for more
+                return;
+              }
+            seq_len_ = node_ = 0;
+            rl_commands[next - rl_trie_len].handler (this);
+            return;
+          }
+        // not a command; if it diverged within a sequence, the rest
+        // of it must be swallowed
+        skip_ = (node_ != 0);
+        node_ = 0;
+      }
+
+    if (!skip_char_seq (seq_))
+      {
+        return;   // glyph or sequence not complete yet
+      }
+    if (!skip_ && (seq_[0] & 0xE0))
+      {
+        insert_seq (seq_);
+      }
+    seq_len_ = 0;
+    skip_ = false;
+  }
+
+  /**
+   * @brief Find the run of text at the start of a buffer: printable
+   *  characters and complete UTF-8 glyphs; in a paste, tabs too.
+   * @param p: pointer to the bytes.
+   * @param len: number of bytes.
+   * @return Length of the run, 0 if it does not start with text.
+   */
+  size_t
+  read_line::text_run (const char* p, size_t len)
+  {
+    size_t n = 0;
+
+    while (n < len)
       {
-        if (!strcmp (cmd->seq, seq))
+        uint8_t c = p[n];
+        if ((c < ' ' || c == 0x7F)
+            && !(paste_ && c == '\t'))
           {
-            cmd->handler (this);
             break;
           }
-        ++cmd;
+        n++;
       }
 
-    if (cmd == end && (seq[0] & 0xE0))
+#if SHELL_UTF8_SUPPORT == true
+    // leave out a glyph cut at the end
+    size_t k = n;
+    while (k && (p[k - 1] & 0xC0) == 0x80)
+      {
+        k--;
+      }
+    if (k && (p[k - 1] & 0xC0) == 0xC0)
       {
-        insert_seq (seq);
+        uint8_t c = p[k - 1];
+        size_t need = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 4;
+        if (n - (k - 1) < need)
+          {
+            n = k - 1;
+          }
       }
+#endif
+
+    return n;
+  }
+
+  /**
+   * @brief Insert a run of text; tabs (from a paste) become spaces.
+   * @param p: pointer to the text.
+   * @param len: length of the text.
+   */
+  void
+  read_line::insert_run (const char* p, size_t len)
+  {
+    char run[sizeof(in_) + 1];
 
-    return finish_;
+    for (size_t i = 0; i < len; i++)
+      {
+        run[i] = (p[i] == '\t') ? ' ' : p[i];
+      }
+    run[len] = '\0';
+    insert_seq (run);
   }
 
   int
@@ -812,82 +1667,51 @@ namespace ushell
   void
   read_line::history_back (class read_line* self)
   {
-    hh_t hh;
-
-    memcpy (&hh, self->current_, sizeof(hh_t));
-    if (hh.next)
+    if (self->current_ == hist_none)
       {
-        if ((self->current_ + hh.next)
-            < (self->history_ + self->hist_len_ - sizeof(hh_t)))
+        if (self->hl_.newest != hist_none)
           {
-            self->current_ += hh.next;
-            memcpy (&hh, self->current_, sizeof(hh_t));
-            if (hh.next != 0
-                && ((self->current_ + hh.next)
-                    < (self->history_ + self->hist_len_)))
-              {
-                self->set_text (self->current_ + sizeof(hh_t), 1);
-              }
-            else
-              {
-                self->current_ -= hh.prev; // turn back
-              }
+            self->history_show (self->hl_.newest);
           }
       }
+    else if (self->current_ != self->hl_.tail)
+      {
+        hh_t hh;
+        memcpy (&hh, self->history_ + self->current_, sizeof(hh_t));
+        self->history_show (hh.prev);
+      }
   }
 
   void
   read_line::history_forward (class read_line* self)
   {
-    hh_t hh;
-
-    memcpy (&hh, self->current_, sizeof(hh_t));
-
-    if (hh.prev)
+    if (self->current_ == hist_none)
       {
-        if ((self->current_ - hh.prev) >= self->history_)
-          {
-            self->current_ -= hh.prev;
-            self->set_text (self->current_ + sizeof(hh_t), 1);
-          }
+        return;
+      }
+    if (self->current_ == self->hl_.newest)
+      {
+        self->history_show (hist_none);
+      }
+    else
+      {
+        self->history_show (self->history_next (self->current_));
       }
   }
 
   void
   read_line::history_begin (class read_line* self)
   {
-    hh_t hh;
-    char* savep = self->current_;
-
-    while (true)
+    if (self->hl_.newest != hist_none)
       {
-        memcpy (&hh, self->current_, sizeof(hh_t));
-        if (hh.next)
-          {
-            if ((self->current_ + hh.next)
-                < (self->history_ + self->hist_len_ - sizeof(hh_t)))
-              {
-                savep = self->current_;
-                self->current_ += hh.next;
-                memcpy (&hh, self->current_, sizeof(hh_t));
-                if (hh.next == 0
-                    || ((self->current_ + hh.next)
-                        >= (self->history_ + self->hist_len_)))
-                  {
-                    break;
-                  }
-              }
-          }
+        self->history_show (self->hl_.tail);
       }
-    self->current_ = savep;
-    self->set_text (self->current_ + sizeof(hh_t), 1);
   }
 
   void
   read_line::history_end (class read_line* self)
   {
-    self->current_ = self->history_;
-    self->set_text (self->current_ + sizeof(hh_t), 1);
+    self->history_show (hist_none);
   }
 
   void
@@ -896,6 +1720,25 @@ namespace ushell
     self->finish_ = true;
   }
 
+  void
+  read_line::cancel (class read_line* self)
+  {
+    self->history_show (hist_none);
+  }
+
+  void
+  read_line::paste_begin (class read_line* self)
+  {
+    self->paste_ = true;
+    self->paste_cr_ = false;
+  }
+
+  void
+  read_line::paste_end (class read_line* self)
+  {
+    self->paste_ = false;
+  }
+
   void
   read_line::autocomplete (class read_line* self)
   {
@@ -0,0 +1,207 @@
+/*
+ * tokenizer.cpp
+ *
+ * Copyright (c) 2026 The micro-shell-plus contributors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tokenizer.h"
+
+namespace ushell
+{
+
+  /**
+   * @brief Tell plain text apart from the characters the tokenizer acts
+   *  on: separators, quotes, backslash and the terminator.
+   * @param c: character.
+   * @return true if plain.
+   */
+  static inline bool
+  plain (char c)
+  {
+    switch (c)
+      {
+      case '\'':
+      case '\"':
+      case '\\':
+        return false;
+
+      default:
+        return static_cast<uint8_t> (c) > ' ';
+      }
+  }
+
+  /**
+   * @brief Split a line into arguments, in one pass over the line buffer.
+   *  The arguments are terminated in place and the argv entries point into
+   *  the line; the argument text is moved only to squeeze out quotes and
+   *  escape characters. If there is room, argv is terminated by a nullptr.
+   * @param line: command line, null terminated; it is modified.
+   * @param argv: array to return the pointers on arguments.
+   * @param max: number of entries in argv.
+   * @return Number of arguments found; if larger than max, only the first max
+   *  were stored.
+   */
+  int
+  tokenizer::split (char* line, char* argv[], int max)
+  {
+    char* r = line;     // read position
+    char* w;            // write position, never ahead of r
+    int argc = 0;
+
+    while (true)
+      {
+        while (*r == ' ' || *r == '\t')
+          {
+            r++;        // skip separators
+          }
+        if (*r == '\0')
+          {
+            break;
+          }
+
+        w = r;
+        if (argc < max)
+          {
+            argv[argc] = w;
+          }
+        argc++;
+
+        char quote = '\0';
+        for (; *r != '\0'; r++)
+          {
+            if (quote == '\0' && w == r)
+              {
+                // nothing dropped so far, plain text stays where it is
+                while (plain (*r))
+                  {
+                    r++;
+                  }
+                w = r;
+                if (*r == '\0')
+                  {
+                    break;
+                  }
+              }
+
+            char c = *r;
+            if (quote == '\0')
+              {
+                if (c == ' ' || c == '\t')
+                  {
+                    break;      // end of argument
+                  }
+                if (c == '\'' || c == '\"')
+                  {
+                    quote = c;
+                    continue;
+                  }
+                if (c == '\\' && r[1] != '\0')
+                  {
+                    c = *++r;
+                  }
+              }
+            else if (c == quote)
+              {
+                quote = '\0';
+                continue;
+              }
+            else if (c == '\\' && quote == '\"'
+                && (r[1] == '\"' || r[1] == '\\'))
+              {
+                c = *++r;
+              }
+
+            if (w != r)
+              {
+                *w = c;         // only after a quote or escape was dropped
+              }
+            w++;
+          }
+
+        bool end = (*r == '\0');
+        *w = '\0';
+        if (end)
+          {
+            break;
+          }
+        r++;
+      }
+
+    if (argc < max)
+      {
+        argv[argc] = nullptr;
+      }
+
+    return argc;
+  }
+
+  /**
+   * @brief Find the first occurrence of a character which is neither quoted
+   *  nor escaped, e.g. a pipeline or redirection operator.
+   * @param line: command line, null terminated.
+   * @param c: character to look for.
+   * @return Pointer on the character, or nullptr if not found.
+   */
+  char*
+  tokenizer::find_unquoted (char* line, char c)
+  {
+    char quote = '\0';
+
+    for (char* r = line; *r != '\0'; r++)
+      {
+        if (quote == '\0')
+          {
+            if (*r == c)
+              {
+                return r;
+              }
+            if (*r == '\'' || *r == '\"')
+              {
+                quote = *r;
+              }
+            else if (*r == '\\' && r[1] != '\0')
+              {
+                r++;
+              }
+          }
+        else if (*r == quote)
+          {
+            quote = '\0';
+          }
+        else if (*r == '\\' && quote == '\"'
+            && (r[1] == '\"' || r[1] == '\\'))
+          {
+            r++;
+          }
+      }
+
+    return nullptr;
+  }
+
+}
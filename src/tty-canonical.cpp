@@ -31,6 +31,9 @@
  * termios flags (LNP).
  */
 
+#include <cstring>
+#include <algorithm>
+#include <new>
 #include <cmsis-plus/diag/trace.h>
 #include "tty-canonical.h"
 
@@ -47,13 +50,31 @@ namespace os
           { impl, name }
     {
       type_ |= static_cast<type_t>(type::tty);
+      build_input_table ();
 #if defined(OS_TRACE_POSIX_IO_TTY)
       trace::printf ("tty_canonical::%s(\"%s\")=@%p\n", __func__, name_, this);
 #endif
     }
 
+    tty_canonical::tty_canonical (tty_timed_impl& impl, const char* name) :
+        tty_canonical
+          { static_cast<tty_impl&> (impl), name }
+    {
+      timed_ = &impl;
+    }
+
     tty_canonical::~tty_canonical () noexcept
     {
+#if TTY_TX_BUFFER_LEN > 0
+      if (txth_ != nullptr)
+        {
+          // the thread sends what is left, then exits
+          txstop_ = true;
+          txdata_.post ();
+          txth_->join ();
+          delete txth_;
+        }
+#endif
 #if defined(OS_TRACE_POSIX_IO_TTY)
       trace::printf ("tty_canonical::%s() @%p %s\n", __func__, this, name_);
 #endif
@@ -87,6 +108,7 @@ namespace os
           lf_.icanon ? (ptio->c_lflag |= ICANON) : (ptio->c_lflag &= ~ICANON);
           lf_.echo ? (ptio->c_lflag |= ECHO) : (ptio->c_lflag &= ~ECHO);
           lf_.echoe ? (ptio->c_lflag |= ECHOE) : (ptio->c_lflag &= ~ECHOE);
+          lf_.isig ? (ptio->c_lflag |= ISIG) : (ptio->c_lflag &= ~ISIG);
 
           if_.istrip ? (ptio->c_iflag |= ISTRIP) : (ptio->c_iflag &= ~ISTRIP);
           if_.icrnl ? (ptio->c_iflag |= ICRNL) : (ptio->c_iflag &= ~ICRNL);
@@ -94,6 +116,8 @@ namespace os
           if_.inlcr ? (ptio->c_iflag |= INLCR) : (ptio->c_iflag &= ~INLCR);
           if_.imaxbel ?
               (ptio->c_iflag |= IMAXBEL) : (ptio->c_iflag &= ~IMAXBEL);
+          if_.ixon ? (ptio->c_iflag |= IXON) : (ptio->c_iflag &= ~IXON);
+          if_.ixoff ? (ptio->c_iflag |= IXOFF) : (ptio->c_iflag &= ~IXOFF);
 
           of_.opost ? (ptio->c_oflag |= OPOST) : (ptio->c_oflag &= ~OPOST);
           of_.onlcr ? (ptio->c_oflag |= ONLCR) : (ptio->c_oflag &= ~ONLCR);
@@ -104,6 +128,11 @@ namespace os
           ptio->c_cc[VEOL2] = cc_.veol2;
           ptio->c_cc[VERASE] = cc_.verase;
           ptio->c_cc[VKILL] = cc_.vkill;
+          ptio->c_cc[VSTART] = cc_.vstart;
+          ptio->c_cc[VSTOP] = cc_.vstop;
+          ptio->c_cc[VINTR] = cc_.vintr;
+          ptio->c_cc[VMIN] = cc_.vmin;
+          ptio->c_cc[VTIME] = cc_.vtime;
         }
 
       return ret;
@@ -111,22 +140,35 @@ namespace os
 
     /**
      * @brief Set the tty configuration.
-     * @param options: optional actions (see termios.h).
+     * @param options: optional actions (see termios.h); with TCSADRAIN and
+     *  TCSAFLUSH, what was written is sent with the old settings first.
      * @param ptio: pointer on a termios structure.
      * @return 0 if successfull, -1 otherwise.
      */
     inline int
     tty_canonical::tcsetattr (int options, const struct termios* ptio)
     {
+      if (options == TCSADRAIN || options == TCSAFLUSH)
+        {
+          tcdrain ();
+        }
+      if (options == TCSAFLUSH)
+        {
+          tcflush (TCIFLUSH);
+        }
+
       lf_.icanon = (ptio->c_lflag & ICANON) ? true : false;
       lf_.echo = (ptio->c_lflag & ECHO) ? true : false;
       lf_.echoe = (ptio->c_lflag & ECHOE) ? true : false;
+      lf_.isig = (ptio->c_lflag & ISIG) ? true : false;
 
       if_.istrip = (ptio->c_iflag & ISTRIP) ? true : false;
       if_.icrnl = (ptio->c_iflag & ICRNL) ? true : false;
       if_.igncr = (ptio->c_iflag & IGNCR) ? true : false;
       if_.inlcr = (ptio->c_iflag & INLCR) ? true : false;
       if_.imaxbel = (ptio->c_iflag & IMAXBEL) ? true : false;
+      if_.ixon = (ptio->c_iflag & IXON) ? true : false;
+      if_.ixoff = (ptio->c_iflag & IXOFF) ? true : false;
 
       of_.opost = (ptio->c_oflag & OPOST) ? true : false;
       of_.onlcr = (ptio->c_oflag & ONLCR) ? true : false;
@@ -137,8 +179,26 @@ namespace os
       cc_.veol2 = ptio->c_cc[VEOL2];
       cc_.verase = ptio->c_cc[VERASE];
       cc_.vkill = ptio->c_cc[VKILL];
+      cc_.vstart = ptio->c_cc[VSTART];
+      cc_.vstop = ptio->c_cc[VSTOP];
+      cc_.vintr = ptio->c_cc[VINTR];
+      cc_.vmin = ptio->c_cc[VMIN];
+      cc_.vtime = ptio->c_cc[VTIME];
+
+      build_input_table ();
+      memcpy (&tio_, ptio, sizeof(struct termios));
+      // the timers are ours, the driver just blocks
+      tio_.c_cc[VMIN] = 1;
+      tio_.c_cc[VTIME] = 0;
+      if (!if_.ixon && ostopped_)
+        {
+          ostopped_ = false; // no flow control, no reason to wait
+#if TTY_TX_BUFFER_LEN > 0
+          txdata_.post ();
+#endif
+        }
 
-      return impl ().do_tcsetattr (options, ptio);
+      return impl ().do_tcsetattr (options, &tio_);
     }
 
     /**
@@ -149,6 +209,41 @@ namespace os
     inline int
     tty_canonical::tcflush (int queue_selector)
     {
+      if (queue_selector == TCIFLUSH || queue_selector == TCIOFLUSH)
+        {
+          // drop what was read ahead too; the ring belongs to the holder
+          // of imx_, which drops it when it lets go, unless it is a reader
+          // waiting on the driver, which only does that with the ring empty
+          if (imx_.try_lock () == rtos::result::ok)
+            {
+              iflush_ = true;
+              input_release ();
+            }
+          else if (!iwait_)
+            {
+              iflush_ = true;
+              // the holder may have let go before it could see the flag
+              if (imx_.try_lock () == rtos::result::ok)
+                {
+                  input_release ();
+                }
+            }
+        }
+#if TTY_TX_BUFFER_LEN > 0
+      if (queue_selector == TCOFLUSH || queue_selector == TCIOFLUSH)
+        {
+          // not while the drain thread sends from the queue, writers would
+          // refill the bytes it is sending
+          txdmx_.lock ();
+            {
+              rtos::scheduler::critical_section cs;
+              txtail_ = txhead_; // drop what is queued
+            }
+          txdmx_.unlock ();
+          txspace_.post ();
+          txidle_.post ();
+        }
+#endif
       return impl ().do_tcflush (queue_selector);
     }
 
@@ -159,6 +254,12 @@ namespace os
     inline int
     tty_canonical::tcdrain (void)
     {
+#if TTY_TX_BUFFER_LEN > 0
+      while (!tx_empty ())
+        {
+          txidle_.wait ();
+        }
+#endif
       return impl ().do_tcdrain ();
     }
 
@@ -173,24 +274,17 @@ namespace os
     {
       ssize_t count;
 
+      imx_.lock ();
       if (lf_.icanon)
         {
           count = get_line (buf, nbyte);
         }
       else
         {
-          if ((count = impl ().do_read (buf, nbyte)) > 0)
-            {
-              if (if_.icrnl || if_.igncr || if_.inlcr || if_.istrip)
-                {
-                  count = process_input (buf, count);
-                }
-              if (lf_.echo)
-                {
-                  impl ().do_write (buf, count);
-                }
-            }
+          count = get_raw (buf, nbyte);
         }
+      input_resume ();
+      input_release ();
 
       return count;
     }
@@ -208,162 +302,647 @@ namespace os
 
       if (nbyte)
         {
+#if TTY_TX_BUFFER_LEN > 0
+          txwmx_.lock ();
+#endif
           if (of_.opost && (of_.ocrnl || of_.onlcr))
             {
               count = put_line (buf, nbyte);
             }
           else
             {
-              count = impl ().do_write (buf, nbyte);
+              count = out_write (buf, nbyte);
             }
+#if TTY_TX_BUFFER_LEN > 0
+          txwmx_.unlock ();
+#endif
         }
 
       return count;
     }
 
+    /**
+     * @brief Wait for input to arrive, leaving it for the next read. The
+     *  attributes must have been set with tcsetattr() before.
+     * @param timeout: maximum time to wait, in system ticks; 0 for ever.
+     * @return 1 if input is available, 0 if the time expired, -1 if the
+     *  driver failed.
+     */
+    int
+    tty_canonical::wait_input (rtos::clock::duration_t timeout)
+    {
+      ssize_t count = 1;
+
+      imx_.lock ();
+      if (ihead_ == itail_)
+        {
+          count = timeout ? fill_input_timed (timeout) : fill_input ();
+        }
+      input_release ();
+
+      return count < 0 ? -1 : (count > 0 ? 1 : 0);
+    }
+
+    /**
+     * @brief Wait for the line to be ready, with the driver's
+     *  do_ready_wait (). A driver without it cannot tell; the first byte
+     *  received is waited for instead, and kept for the next read.
+     * @param timeout: maximum time to wait, in system ticks.
+     * @return true if the line is ready, false if the time expired or the
+     *  driver failed.
+     */
+    bool
+    tty_canonical::wait_ready (rtos::clock::duration_t timeout)
+    {
+      if (timed_ == nullptr)
+        {
+          return timeout != 0 && wait_input (timeout) > 0;
+        }
+      return timed_->do_ready_wait (timeout);
+    }
+
+    /**
+     * @brief Tell if INTR was received; if nobody reads, the input is
+     *  polled for it at most once per tick, so this can be called often.
+     * @return true if INTR was received since the last clear_interrupt().
+     */
+    bool
+    tty_canonical::interrupted (void)
+    {
+      if (!intr_ && lf_.isig)
+        {
+          rtos::clock::timestamp_t now = rtos::sysclock.now ();
+          if (now != polled_)
+            {
+              polled_ = now;
+              poll_input ();
+            }
+        }
+      return intr_;
+    }
+
+    /**
+     * @brief Clear the interrupt flag.
+     * @return true if INTR was received since the last call.
+     */
+    bool
+    tty_canonical::clear_interrupt (void)
+    {
+      bool intr = intr_;
+      intr_ = false;
+      return intr;
+    }
+
     /**
      * @brief Implements the canonical input mode; this call returns either after
      *  an end of line character is received or the buffer becomes full.
+     *  Input is read from the driver in chunks, as much as it has available,
+     *  and the echo of a chunk is sent with a single write.
      * @param buf: input buffer.
      * @param nbyte: buffer length.
-     * @return Number of characters in the buffer, or EOF if error at read.
+     * @return Number of characters in the buffer, 0 if INTR discarded the
+     *  line, or EOF if error at read.
      */
-    int
+    ssize_t
     tty_canonical::get_line (void* buf, std::size_t nbyte)
     {
-      int c, n = 0;
-      char* p = (char*) buf;
+      int c = 0;
+      std::size_t n = 0;
+      char* p = static_cast<char*> (buf);
 
       do
         {
-          c = 0;
-          if (impl ().do_read (&c, 1) > 0)
+          if (ihead_ == itail_)
             {
-              if (c == cc_.veof)
+              // chunk consumed, show its echo before waiting for more
+              echo_flush ();
+              ssize_t count = fill_input ();
+              if (count <= 0)
                 {
-                  break; // end of file
-                }
-              if (c == cc_.verase)
-                {
-                  // handle erase
-                  if (n > 0)
+                  if (count == 0 && intr_)
                     {
-                      if (lf_.echoe)
-                        {
-                          char _bs[] =
-                            { '\b', ' ', '\b', '\0' };
-                          _bs[0] = _bs[2] = cc_.verase;
-                          for (char* s = _bs; *s != '\0'; s++)
-                            {
-                              echo_char (*s);
-                            }
-                        }
-                      else
-                        {
-                          echo_char (c);
-                        }
-                      p--;
-                      n--;
+                      n = 0; // INTR discards the line
                     }
+                  break;
                 }
-              else if (c == cc_.vkill)
+            }
+          c = static_cast<uint8_t> (ibuf_[itail_++
+              & (TTY_INPUT_BUFFER_LEN - 1)]);
+
+          if (c == cc_.veof)
+            {
+              break; // end of file
+            }
+          if (c == cc_.verase)
+            {
+              // handle erase
+              if (n > 0)
                 {
-                  // handle kill
-                  char _kill[] =
-                    { esc, '[', 'K', '\0' };
-                  while (n)
+                  if (lf_.echoe)
                     {
                       echo_char (cc_.verase);
-                      n--;
+                      echo_char (' ');
+                      echo_char (cc_.verase);
                     }
-                  for (char* s = _kill; *s != '\0'; s++)
+                  else
                     {
-                      echo_char (*s);
+                      echo_char (c);
                     }
-                  p = (char*) buf;
+                  p--;
+                  n--;
                 }
-              else
+            }
+          else if (c == cc_.vkill)
+            {
+              // handle kill
+              while (n)
+                {
+                  echo_char (cc_.verase);
+                  n--;
+                }
+              echo_char (esc);
+              echo_char ('[');
+              echo_char ('K');
+              p = static_cast<char*> (buf);
+            }
+          else
+            {
+              // handle iflags
+              if (idrop_[c >> 5] & (1u << (c & 31)))
+                {
+                  continue;
+                }
+              c = ixlat_[c];
+
+              if (n >= nbyte)
                 {
-                  // handle iflags
-                  if (if_.istrip)
+                  // buffer overflow; leave the character for the next read
+                  itail_--;
+                  if (if_.imaxbel)
                     {
-                      c &= 0x7F;
+                      echo_char (bell);
                     }
-                  if (c == '\r')
+                  break;
+                }
+
+              // store character in buffer
+              *p++ = (char) c;
+              n++;
+
+              // handle oflags
+              if (c == '\r')
+                {
+                  if (of_.opost && of_.ocrnl)
                     {
-                      if (if_.igncr)
-                        {
-                          continue;
-                        }
-                      else if (if_.icrnl)
-                        {
-                          c = '\n';
-                        }
+                      echo_char ('\n');
                     }
-                  else if (c == '\n' && if_.inlcr)
+                  else
                     {
-                      c = '\r';
+                      echo_char ('\r');
                     }
-
-                  // store character in buffer
-                  *p++ = (char) c;
-                  if (n++ >= (int) nbyte)
+                }
+              else if (c == '\n')
+                {
+                  if (of_.opost && of_.onlcr)
                     {
-                      // buffer overflow
-                      p--;
-                      n--;
-                      if (if_.imaxbel)
-                        {
-                          echo_char (bell);
-                        }
-                      c = '\n'; // force an exit
+                      echo_char ('\r');
                     }
-                  else
+                  echo_char ('\n');
+                }
+              else
+                {
+                  echo_char (c);
+                }
+            }
+        }
+      while (c != '\n');
+
+      echo_flush ();
+
+      return n;
+    }
+
+    /**
+     * @brief Implements the non-canonical input mode, with the POSIX VMIN
+     *  and VTIME semantics; the timer is run here, see fill_input_timed ().
+     *  - VMIN > 0, VTIME = 0: wait for VMIN bytes;
+     *  - VMIN > 0, VTIME > 0: wait for the first byte, then for VMIN bytes
+     *    or until the gap between two bytes exceeds VTIME;
+     *  - VMIN = 0, VTIME > 0: return what arrives within VTIME, maybe nothing;
+     *  - VMIN = 0, VTIME = 0: return what is available, maybe nothing.
+     * @param buf: input buffer.
+     * @param nbyte: buffer length.
+     * @return Number of characters returned in the buffer, -1 if error.
+     */
+    ssize_t
+    tty_canonical::get_raw (void* buf, std::size_t nbyte)
+    {
+      char* p = static_cast<char*> (buf);
+      std::size_t want = std::min (static_cast<std::size_t> (cc_.vmin), nbyte);
+      rtos::clock::duration_t vtime = cc_.vtime * rtos::sysclock.frequency_hz
+          / 10;
+      std::size_t count = 0;
+      ssize_t n;
+
+      while (count < nbyte)
+        {
+          // input goes through the ring buffer, which also holds what was
+          // read ahead by a previous canonical read or while polling
+          if (ihead_ == itail_)
+            {
+              if (count && count >= want)
+                {
+                  break;
+                }
+              if (cc_.vmin == 0 || (count && vtime))
+                {
+                  // the read timer, or the inter-byte timer once the first
+                  // byte arrived; with VTIME = 0, only what is there
+                  n = fill_input_timed (vtime);
+                }
+              else
+                {
+                  n = fill_input ();
+                }
+              if (n <= 0)
+                {
+                  if (n < 0 && count == 0)
                     {
-                      // handle oflags
-                      if (c == '\r')
-                        {
-                          if (of_.opost && of_.ocrnl)
-                            {
-                              echo_char ('\n');
-                            }
-                          else
-                            {
-                              echo_char ('\r');
-                            }
-                        }
-                      else if (c == '\n')
-                        {
-                          if (of_.opost && of_.onlcr)
-                            {
-                              echo_char ('\r');
-                              echo_char ('\n');
-                            }
-                          else
-                            {
-                              echo_char ('\n');
-                            }
-                        }
-                      else
-                        {
-                          echo_char (c);
-                        }
+                      return n;
                     }
+                  break; // timer expired, or nothing available
+                }
+            }
+          n = read_input (p + count, nbyte - count);
+
+          if (ixlat_on_)
+            {
+              n = process_input (p + count, n);
+            }
+          if (lf_.echo)
+            {
+              for (const char* e = p + count; e < p + count + n;)
+                {
+                  std::size_t k = std::min (
+                      static_cast<std::size_t> (p + count + n - e),
+                      sizeof(ebuf_) - elen_);
+                  memcpy (ebuf_ + elen_, e, k);
+                  elen_ += k;
+                  e += k;
+                  echo_flush ();
                 }
+            }
+          count += n;
+
+          if (cc_.vmin == 0)
+            {
+              break; // return as soon as something is available
+            }
+        }
+
+      return count;
+    }
+
+    /**
+     * @brief Read from the driver into the input ring buffer, as much as
+     *  fits in the contiguous free space; blocks as the driver does. With
+     *  IXOFF, STOP is sent when the buffer gets above the high-water mark.
+     *  Note that the ring is only filled on demand, by readers and by
+     *  writers polling for START/STOP, so this paces the peer to the
+     *  reader; it does not keep the driver's own receive buffer from
+     *  overrunning, the driver needs its own flow control (RTS/CTS) or a
+     *  buffer that covers the peer's reaction time.
+     * @param block: true to read again if all bytes read were flow control
+     *  characters, false to return 0 then; 0 is also returned on INTR, so
+     *  that the reader can act on it.
+     * @return Number of bytes read, 0 or -1 as returned by the driver.
+     */
+    ssize_t
+    tty_canonical::fill_input (bool block)
+    {
+      input_resume ();
+      if (ihead_ == itail_)
+        {
+          ihead_ = itail_ = 0; // empty, the whole buffer is free
+        }
+
+      std::size_t head = ihead_ & (TTY_INPUT_BUFFER_LEN - 1);
+      std::size_t room = TTY_INPUT_BUFFER_LEN - (ihead_ - itail_);
+      if (room > TTY_INPUT_BUFFER_LEN - head)
+        {
+          room = TTY_INPUT_BUFFER_LEN - head;
+        }
+      if (room == 0)
+        {
+          return 0;
+        }
+
+      ssize_t count;
+      do
+        {
+          iwait_ = block && ihead_ == itail_; // see tcflush()
+          count = impl ().do_read (&ibuf_[head], room);
+          iwait_ = false;
+          if (count <= 0)
+            {
+              return count;
+            }
+        }
+      while ((count = scan_input (&ibuf_[head], count)) == 0 && block
+          && !intr_);
+      ihead_ += count;
+
+      if (if_.ixoff && !isent_stop_
+          && ihead_ - itail_ >= TTY_INPUT_BUFFER_LEN * 3 / 4)
+        {
+          isent_stop_ = true;
+          out_direct (&cc_.vstop, 1);
+        }
+      return count;
+    }
+
+    /**
+     * @brief Read from the driver into the input ring buffer, waiting at
+     *  most a given time for something to arrive. A driver with
+     *  do_rx_wait () is waited on; any other times the read itself, with
+     *  VMIN = 0 and VTIME set for that read only.
+     * @param timeout: maximum time to wait, in system ticks; 0 not to wait.
+     * @return Number of bytes read, 0 if the time expired or INTR was
+     *  received, -1 if the driver failed.
+     */
+    ssize_t
+    tty_canonical::fill_input_timed (rtos::clock::duration_t timeout)
+    {
+      rtos::clock::timestamp_t start = rtos::sysclock.now ();
+      rtos::clock::duration_t left = timeout;
+      ssize_t count;
 
+      for (;;)
+        {
+          if (timed_ == nullptr)
+            {
+              count = fill_input_vtime (left);
+            }
+          else if (timed_->do_rx_wait (left))
+            {
+              count = fill_input (false);
             }
           else
+            {
+              count = 0;
+              break;
+            }
+          if (count != 0 || intr_)
             {
               break;
             }
+          rtos::clock::duration_t elapsed = rtos::sysclock.now () - start;
+          if (elapsed >= timeout)
+            {
+              break;
+            }
+          left = timeout - elapsed;
         }
-      while (c != '\n');
 
+      return count;
+    }
+
+    /**
+     * @brief Read from a driver without do_rx_wait (), which times the
+     *  read itself: VTIME is set to the timeout, in tenths of a second
+     *  rounded up and at most 255, for this read only.
+     * @param timeout: maximum time to wait, in system ticks.
+     * @return Number of bytes read, 0 if the time expired, -1 if the
+     *  driver failed.
+     */
+    ssize_t
+    tty_canonical::fill_input_vtime (rtos::clock::duration_t timeout)
+    {
+      rx_timeout (timeout);
+      ssize_t count = fill_input (false);
+      rx_block ();
+
+      return count;
+    }
+
+    /**
+     * @brief Set a driver without do_rx_wait () up for timed reads: VMIN = 0
+     *  and VTIME the timeout, in tenths of a second rounded up and at most
+     *  255; 0 for reads that do not wait.
+     * @param timeout: maximum time to wait, in system ticks.
+     */
+    void
+    tty_canonical::rx_timeout (rtos::clock::duration_t timeout)
+    {
+      rtos::clock::duration_t tenths = (timeout * 10
+          + rtos::sysclock.frequency_hz - 1) / rtos::sysclock.frequency_hz;
+
+      tio_.c_cc[VMIN] = 0;
+      tio_.c_cc[VTIME] = tenths > 255 ? 255 : tenths;
+      impl ().do_tcsetattr (TCSANOW, &tio_);
+    }
+
+    /**
+     * @brief Set the driver back up for blocking reads, VMIN = 1 and
+     *  VTIME = 0.
+     */
+    void
+    tty_canonical::rx_block (void)
+    {
+      tio_.c_cc[VMIN] = 1;
+      tio_.c_cc[VTIME] = 0;
+      impl ().do_tcsetattr (TCSANOW, &tio_);
+    }
+
+    /**
+     * @brief Act on and remove the flow control characters, if IXON, and
+     *  the interrupt character, if ISIG.
+     * @param buf: bytes just read from the driver.
+     * @param nbyte: number of bytes.
+     * @return Number of bytes left in the buffer.
+     */
+    std::size_t
+    tty_canonical::scan_input (char* buf, std::size_t nbyte)
+    {
+      if (!if_.ixon && !lf_.isig)
+        {
+          return nbyte;
+        }
+
+      char* q = buf;
+      for (char* p = buf; p < buf + nbyte; p++)
+        {
+          uint8_t c = *p;
+          if (lf_.isig && c == cc_.vintr)
+            {
+              intr_ = true;
+            }
+          else if (!if_.ixon)
+            {
+              *q++ = c;
+            }
+          else if (c == cc_.vstop)
+            {
+              ostopped_ = true;
+            }
+          else if (c == cc_.vstart)
+            {
+              ostopped_ = false;
+#if TTY_TX_BUFFER_LEN > 0
+              txdata_.post (); // wake up the drain thread
+#endif
+            }
+          else
+            {
+              *q++ = c;
+            }
+        }
+      return q - buf;
+    }
+
+    /**
+     * @brief Read what the driver has, without waiting; used by writers to
+     *  catch STOP/START and INTR while nobody reads. Skipped if a reader is
+     *  active, as it will see them anyway. A driver without do_rx_wait ()
+     *  gets a read with VMIN = VTIME = 0, which returns at once.
+     */
+    void
+    tty_canonical::poll_input (void)
+    {
+      if (imx_.try_lock () != rtos::result::ok)
+        {
+          return;
+        }
+
+      if (timed_ == nullptr)
+        {
+          rx_timeout (0);
+          read_ahead ();
+          rx_block ();
+        }
+      else if (timed_->do_rx_wait (0))
+        {
+          read_ahead ();
+        }
+
+      input_release ();
+    }
+
+    /**
+     * @brief Read from the driver into the input ring buffer, for the
+     *  flow control and INTR characters in the input; blocks as the driver
+     *  does. The caller holds imx_.
+     * @return Number of bytes read, 0 or -1 as returned by the driver.
+     */
+    ssize_t
+    tty_canonical::read_ahead (void)
+    {
+      if (ihead_ - itail_ < TTY_INPUT_BUFFER_LEN)
+        {
+          return fill_input (false);
+        }
+
+      // the peer ignored our STOP; look for its START, drop the rest
+      char c[8];
+      ssize_t n = impl ().do_read (c, sizeof(c));
+      if (n > 0)
+        {
+          scan_input (c, n);
+        }
+      return n;
+    }
+
+    /**
+     * @brief Wait for START while output is stopped, reading the input in
+     *  the driver; a reader holding imx_ meanwhile sees START as well.
+     */
+    void
+    tty_canonical::wait_start (void)
+    {
+      while (ostopped_)
+        {
+          imx_.lock ();
+          if (ostopped_ && read_ahead () < 0)
+            {
+              ostopped_ = false; // the driver failed, START will not come
+            }
+          input_release ();
+        }
+    }
+
+    /**
+     * @brief Let go of the input ring buffer, unlocking imx_; if tcflush()
+     *  asked meanwhile, what is left in it is dropped first.
+     */
+    void
+    tty_canonical::input_release (void)
+    {
+      if (iflush_)
+        {
+          iflush_ = false;
+          ihead_ = itail_ = 0;
+          input_resume ();
+        }
+      imx_.unlock ();
+    }
+
+    /**
+     * @brief Send START if input was stopped and the input buffer drained
+     *  to the low-water mark.
+     */
+    void
+    tty_canonical::input_resume (void)
+    {
+      if (isent_stop_ && ihead_ - itail_ <= TTY_INPUT_BUFFER_LEN / 4)
+        {
+          isent_stop_ = false;
+          out_direct (&cc_.vstart, 1);
+        }
+    }
+
+    /**
+     * @brief Output flow control: look for STOP at most once per tick and,
+     *  once received, wait for START before going on.
+     */
+    void
+    tty_canonical::flow_control (void)
+    {
+      if (!if_.ixon)
+        {
+          return;
+        }
+
+      rtos::clock::timestamp_t now = rtos::sysclock.now ();
+      if (now != polled_)
+        {
+          polled_ = now;
+          poll_input ();
+        }
+      wait_start ();
+    }
+
+    /**
+     * @brief Move bytes already read ahead from the input ring buffer.
+     * @param buf: destination buffer.
+     * @param nbyte: buffer length.
+     * @return Number of bytes returned in the buffer.
+     */
+    std::size_t
+    tty_canonical::read_input (void* buf, std::size_t nbyte)
+    {
+      char* p = static_cast<char*> (buf);
+      std::size_t n = 0;
+
+      while (n < nbyte && ihead_ != itail_)
+        {
+          p[n++] = ibuf_[itail_++ & (TTY_INPUT_BUFFER_LEN - 1)];
+        }
       return n;
     }
 
     /**
-     * @brief Stub function to send characters to the tty w/wo echoing them.
+     * @brief Collect a character to be echoed; the echo buffer is sent
+     *  to the tty when full or by echo_flush().
      * @param c: character to be sent.
      */
     inline void
@@ -371,75 +950,348 @@ namespace os
     {
       if (lf_.echo)
         {
-          impl ().do_write (&c, 1);
+          if (elen_ >= sizeof(ebuf_))
+            {
+              echo_flush ();
+            }
+          ebuf_[elen_++] = c;
+        }
+    }
+
+    /**
+     * @brief Send the collected echo to the tty.
+     */
+    void
+    tty_canonical::echo_flush (void)
+    {
+      if (elen_)
+        {
+          out_direct (ebuf_, elen_);
+          elen_ = 0;
         }
     }
 
     /**
-     * @brief Implements the raw output mode.
+     * @brief Send the echo or a flow control character, not subject to
+     *  flow control.
      * @param buf: buffer to send to the tty.
      * @param nbyte: number of bytes to send.
-     * @return Number of bytes sent.
+     */
+    void
+    tty_canonical::out_direct (const void* buf, std::size_t nbyte)
+    {
+#if TTY_TX_BUFFER_LEN > 0
+      // ahead of what is queued, so the echo of what is typed shows while
+      // bulk output drains; it never waits for txwmx_ either: a writer may
+      // hold it while output is stopped, and the START resuming it may be
+      // in the input that produced this echo
+      // not in the middle of a chunk the drain thread sends
+      txdmx_.lock ();
+      impl ().do_write (buf, nbyte);
+      txdmx_.unlock ();
+#else
+      impl ().do_write (buf, nbyte);
+#endif
+    }
+
+    /**
+     * @brief Send output to the driver, or to the transmit queue if there
+     *  is one; the caller holds txwmx_.
+     * @param buf: buffer to send to the tty.
+     * @param nbyte: number of bytes to send.
+     * @return Number of bytes sent or queued, -1 if error.
+     */
+    ssize_t
+    tty_canonical::out_write (const void* buf, std::size_t nbyte)
+    {
+      flow_control ();
+#if TTY_TX_BUFFER_LEN > 0
+      if (txth_ != nullptr || tx_start ())
+        {
+          return tx_enqueue (buf, nbyte);
+        }
+#endif
+      return impl ().do_write (buf, nbyte);
+    }
+
+#if TTY_TX_BUFFER_LEN > 0
+
+    /**
+     * @brief Create the thread draining the transmit queue, on first use.
+     * @return true if the thread is running, false otherwise.
+     */
+    bool
+    tty_canonical::tx_start (void)
+    {
+      rtos::thread::attributes attr;
+      attr.th_stack_size_bytes = TTY_TX_STACK_SIZE;
+
+      txth_ = new (std::nothrow) rtos::thread
+        { "tty-tx", tx_th, this, attr };
+
+      return txth_ != nullptr;
+    }
+
+    /**
+     * @brief Copy data to the transmit queue, waiting for the drain thread
+     *  to make room when it is full; the caller holds txwmx_. While output
+     *  is stopped, START is waited for in the input, in case nobody reads
+     *  it.
+     * @param buf: buffer to send to the tty.
+     * @param nbyte: number of bytes to send.
+     * @return Number of bytes queued, -1 if the driver failed sending
+     *  the queue since the last call.
+     */
+    ssize_t
+    tty_canonical::tx_enqueue (const void* buf, std::size_t nbyte)
+    {
+      const char* p = static_cast<const char*> (buf);
+      std::size_t n = nbyte;
+
+      if (txerr_)
+        {
+          txerr_ = false;
+          errno = txerrno_;
+          return -1;
+        }
+
+      while (n)
+        {
+          std::size_t used;
+            {
+              rtos::scheduler::critical_section cs;
+              used = txhead_ - txtail_;
+            }
+          if (used == TTY_TX_BUFFER_LEN)
+            {
+              if (txspace_.timed_wait (1) != rtos::result::ok && ostopped_)
+                {
+                  wait_start ();
+                }
+              continue;
+            }
+
+          std::size_t head = txhead_ & (TTY_TX_BUFFER_LEN - 1);
+          std::size_t k = std::min (n, TTY_TX_BUFFER_LEN - used);
+          k = std::min (k, TTY_TX_BUFFER_LEN - head);
+          memcpy (&txbuf_[head], p, k);
+            {
+              rtos::scheduler::critical_section cs;
+              txhead_ += k;
+            }
+          txdata_.post ();
+          p += k;
+          n -= k;
+        }
+
+      return nbyte;
+    }
+
+    /**
+     * @brief Return true if all queued output was sent to the driver.
+     */
+    bool
+    tty_canonical::tx_empty (void)
+    {
+      rtos::scheduler::critical_section cs;
+      return txhead_ == txtail_;
+    }
+
+    /**
+     * @brief Return the number of bytes that can be queued without waiting.
+     */
+    std::size_t
+    tty_canonical::tx_room (void)
+    {
+      rtos::scheduler::critical_section cs;
+      return TTY_TX_BUFFER_LEN - (txhead_ - txtail_);
+    }
+
+    /**
+     * @brief The thread draining the transmit queue; the data is sent in
+     *  chunks, so that a direct write never waits for more than one chunk.
+     *  A short write sends the rest with the next one; if the driver fails,
+     *  the queue is dropped and the error reported to the next writer.
+     * @param args: pointer to the tty.
+     * @return nullptr.
+     */
+    void*
+    tty_canonical::tx_th (void* args)
+    {
+      tty_canonical* tty = static_cast<tty_canonical*> (args);
+      std::size_t tail, used;
+
+      for (;;)
+        {
+          if (tty->ostopped_ && !tty->txstop_)
+            {
+              tty->txdata_.wait (); // posted when START is received
+              continue;
+            }
+          tty->txdmx_.lock ();
+            {
+              rtos::scheduler::critical_section cs;
+              tail = tty->txtail_;
+              used = tty->txhead_ - tail;
+            }
+          if (used == 0)
+            {
+              tty->txdmx_.unlock ();
+              tty->txidle_.post ();
+              if (tty->txstop_)
+                {
+                  break;
+                }
+              tty->txdata_.wait ();
+              continue;
+            }
+
+          std::size_t index = tail & (TTY_TX_BUFFER_LEN - 1);
+          std::size_t k = std::min (used, TTY_TX_BUFFER_LEN - index);
+          if (k > tx_chunk)
+            {
+              k = tx_chunk;
+            }
+          ssize_t sent = tty->impl ().do_write (&tty->txbuf_[index], k);
+          if (sent <= 0)
+            {
+              // drop what is queued, writers must not wait for it
+              tty->txerrno_ = (sent < 0) ? errno : EIO;
+              tty->txerr_ = true;
+              rtos::scheduler::critical_section cs;
+              tty->txtail_ = tty->txhead_;
+            }
+          else
+            {
+              rtos::scheduler::critical_section cs;
+              tty->txtail_ = tail + sent;
+            }
+          tty->txdmx_.unlock ();
+          tty->txspace_.post ();
+        }
+
+      return nullptr;
+    }
+
+#endif
+
+    /**
+     * @brief Implements the raw output mode; the text is expanded into a
+     *  staging buffer, sent with one write each time it fills up. Runs
+     *  longer than the staging buffer are sent directly.
+     * @param buf: buffer to send to the tty.
+     * @param nbyte: number of bytes to send.
+     * @return Number of bytes sent, or -1 if the driver failed.
      */
     ssize_t
     tty_canonical::put_line (const void* buf, std::size_t nbyte)
     {
-      ssize_t count = 0, n;
+      char stage[TTY_OUTPUT_STAGE_LEN];
+      std::size_t len = 0;
       const char* p = static_cast<const char*> (buf);
-      const char* q = static_cast<const char*> (buf);
+      const char* end = p + nbyte;
 
-      do
+      while (p < end)
         {
-          if ((*p == '\n' && of_.onlcr) || (*p == '\r' && of_.ocrnl))
+          // find the next character to be translated
+          const char* s = nullptr;
+          if (of_.onlcr)
+            {
+              s = static_cast<const char*> (memchr (p, '\n', end - p));
+            }
+          if (of_.ocrnl)
             {
-              if (p - q)
+              const char* r = static_cast<const char*> (memchr (
+                  p, '\r', (s ? s : end) - p));
+              if (r)
                 {
-                  if ((n = impl ().do_write (q, p - q)) < 0)
-                    {
-                      count = n;
-                      break;
-                    }
-                  else
-                    {
-                      count += n;
-                    }
+                  s = r;
                 }
-              if (*p == '\n')
+            }
+
+          std::size_t run = (s ? s : end) - p;
+          if (len + run > sizeof(stage))
+            {
+              if (len && out_write (stage, len) < 0)
                 {
-                  impl ().do_write ("\r\n", 2);
+                  return -1;
                 }
-              else
+              len = 0;
+              if (run >= sizeof(stage))
                 {
-                  impl ().do_write ("\n", 1);
+                  if (out_write (p, run) < 0)
+                    {
+                      return -1;
+                    }
+                  p += run;
+                  run = 0;
                 }
-              count++;
-              p++;
-              q = p;
             }
-          else
+          memcpy (stage + len, p, run);
+          len += run;
+          p += run;
+
+          if (s)
             {
+              if (len + 2 > sizeof(stage))
+                {
+                  if (out_write (stage, len) < 0)
+                    {
+                      return -1;
+                    }
+                  len = 0;
+                }
+              if (*s == '\n')
+                {
+                  stage[len++] = '\r';
+                }
+              stage[len++] = '\n';
               p++;
             }
         }
-      while (--nbyte);
 
-      if (p - q)        // anything left to write?
+      if (len && out_write (stage, len) < 0)
+        {
+          return -1;
+        }
+
+      return nbyte;
+    }
+
+    /**
+     * @brief Build the input translation table from the current iflags;
+     *  ISTRIP is applied first, then the CR/NL mapping of the result.
+     */
+    void
+    tty_canonical::build_input_table (void)
+    {
+      memset (idrop_, 0, sizeof(idrop_));
+      for (int i = 0; i < 256; i++)
         {
-          if ((n = impl ().do_write (q, p - q)) < 0)
+          uint8_t c = if_.istrip ? (i & 0x7F) : i;
+          if (c == '\r')
             {
-              count = n;
+              if (if_.igncr)
+                {
+                  idrop_[i >> 5] |= 1u << (i & 31);
+                }
+              else if (if_.icrnl)
+                {
+                  c = '\n';
+                }
             }
-          else
+          else if (c == '\n' && if_.inlcr)
             {
-              count += n;
+              c = '\r';
             }
+          ixlat_[i] = c;
         }
-
-      return count;
+      ixlat_on_ = if_.icrnl || if_.igncr || if_.inlcr || if_.istrip;
     }
 
     /**
-     * @brief Implements the raw input mode.
+     * @brief Implements the raw input mode; translates the buffer in place
+     *  in a single pass, dropping the ignored characters.
      * @param buf: input buffer.
      * @param nbyte: buffer's length.
      * @return Number of characters returned in the buffer.
@@ -447,34 +1299,19 @@ namespace os
     ssize_t
     tty_canonical::process_input (void* buf, ssize_t nbyte)
     {
-      char* p = static_cast<char*> (buf);
-      ssize_t n = nbyte;
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      uint8_t* q = p;
 
-      do
+      for (const uint8_t* end = p + nbyte; p < end; p++)
         {
-          if (*p == '\r' && if_.igncr)
-            {
-              memmove (p, p + 1, nbyte - 1);
-              n--;
-              continue;
-            }
-          if (if_.istrip)
-            {
-              *p &= 0x7F;
-            }
-          if (*p == '\r' && if_.icrnl && if_.igncr == false)
+          uint8_t c = *p;
+          if ((idrop_[c >> 5] & (1u << (c & 31))) == 0)
             {
-              *p = '\n';
+              *q++ = ixlat_[c];
             }
-          else if (*p == '\n' && if_.inlcr)
-            {
-              *p = '\r';
-            }
-          p++;
         }
-      while (--nbyte);
 
-      return n;
+      return q - static_cast<uint8_t*> (buf);
     }
 
   // ========================================================================
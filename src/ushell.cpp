@@ -30,8 +30,16 @@
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 #include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/file-system.h>
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <assert.h>
+#include <new>
 
 #include "ushell.h"
+#include "tokenizer.h"
 
 #if !defined SHELL_GREET
 #define SHELL_GREET "\nType \"help\" for the list of available commands\n"
@@ -42,7 +50,7 @@
 #endif
 
 #if !defined SHELL_MAX_CMD_ARGS
-#define SHELL_MAX_CMD_ARGS 10
+#define SHELL_MAX_CMD_ARGS 10 // arguments, the command name included
 #endif
 
 using namespace os;
@@ -53,7 +61,12 @@ using namespace os;
 namespace ushell
 {
 
-  class ushell_cmd* ushell::ushell_cmds_[SHELL_MAX_COMMANDS];
+  class ushell_cmd* ushell::first_ = nullptr;
+  class ushell_cmd* ushell::last_ = nullptr;
+  class ushell_cmd* ushell::cmd_index_[SHELL_CMD_INDEX_LEN];
+  class ushell_cmd* ushell::pending_ = nullptr;
+  class ushell_cmd* ushell::unnamed_ = nullptr;
+  uint32_t ushell::link_order_ = 0;
 
   ushell::ushell (const char* char_device) :
       ushell
@@ -71,6 +84,26 @@ namespace ushell
     trace::printf ("%s() %p\n", __func__, this);
   }
 
+#if SHELL_PIPE_SUPPORT == true
+  /**
+   * @brief Constructor for the context of a pipeline stage; it inherits the
+   *  tty and the current directory of the session.
+   * @param parent: the session's shell.
+   */
+  ushell::ushell (const ushell* parent) :
+      char_device_
+        { parent->char_device_ }, //
+      rl_
+        { nullptr }
+  {
+    trace::printf ("%s() %p\n", __func__, this);
+    tty = parent->tty;
+#if SHELL_FILE_SUPPORT == true
+    ph = parent->ph;
+#endif
+  }
+#endif
+
   ushell::~ushell ()
   {
     trace::printf ("%s() %p\n", __func__, this);
@@ -80,6 +113,7 @@ namespace ushell
   ushell::do_ushell (void* args)
   {
     int c;
+    bool failed = true; // no line read, and not left on purpose
     char buffer[SHELL_MAX_LINE_LEN], * p;
     char greet[] =
       { SHELL_GREET };
@@ -94,21 +128,35 @@ namespace ushell
     if (tty != nullptr)
       {
         struct termios tio_orig, tio;
+        tty_sink tty_out
+          { tty };
 
-        rtos::sysclock.sleep_for (rtos::sysclock.frequency_hz * 2);
+        out_ = &tty_out;
+        olen_ = 0;
 
         if (!((tty->tcgetattr (&tio)) < 0))
           {
             // configure the tty in canonical mode
             memcpy (&tio_orig, &tio, sizeof(struct termios));
+#if SHELL_FLOW_CONTROL == true
+            tio.c_iflag |= (IXON | IXOFF); // XON/XOFF flow control
+#else
+            tio.c_iflag &= ~(IXON | IXOFF);
+#endif
+#if SHELL_ISIG == true
+            tio.c_lflag |= ISIG;           // ctrl-c cancels a command
+            tio.c_cc[VINTR] = 3;
+#else
+            tio.c_lflag &= ~ISIG;
+#endif
 
 #if SHELL_USE_READLINE == true
-            tio.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+            tio.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP);
             tio.c_oflag |= (OPOST | ONLCR);
             tio.c_cflag |= CS8;
             tio.c_lflag &= ~(ECHO | ICANON | IEXTEN);
-            tio.c_cc[VMIN] = 1;
-            tio.c_cc[VTIME] = 0;
+            tio.c_cc[VMIN] = 1;   // blocking reads, readline runs its own
+            tio.c_cc[VTIME] = 0;  // timers with wait_input ()
             rl_->initialise (tty);
 #else
             tio.c_lflag |= (ICANON | ECHO | ECHOE);
@@ -119,17 +167,35 @@ namespace ushell
 #endif
             if (!((tty->tcsetattr (TCSANOW, &tio)) < 0))
               {
+#if SHELL_START_TIMEOUT > 0
+                // greet as soon as someone is there, as the driver tells
+                // or with the first key received, or after
+                // SHELL_START_TIMEOUT seconds at most; the key is kept for
+                // the first line
+                tty->wait_ready (
+                    SHELL_START_TIMEOUT * rtos::sysclock.frequency_hz);
+#endif
                 tty->write (greet, strlen (greet));
                 do
                   {
 #if SHELL_USE_READLINE == true
-                    c = rl_->readline (prompt, buffer, sizeof(buffer));
+                    c = rl_->readline (prompt, buffer, sizeof(buffer),
+                                         SHELL_IDLE_TIMEOUT);
+                    if (c < 0 && errno == ETIMEDOUT)
+                      {
+                        failed = false;
+                        exmx_.lock ();
+                        printf ("\nerror %d\n", ush_user_timeout);
+                        flush ();
+                        exmx_.unlock ();
+                      }
 #else
                     tty->write (prompt, strlen (prompt));
                     c = tty->read (buffer, sizeof(buffer));
 #endif
                     if (c > 0)
                       {
+                        failed = false;
                         p = buffer;
                         for (int n = 0; n < c; n++, p++)
                           {
@@ -142,52 +208,130 @@ namespace ushell
                         // clear buffer to end
                         memset (p, 0, sizeof(buffer) - c);
 
-                        // parse and execute command
+                        // parse and execute command; exec () on this shell
+                        // waits meanwhile, they share the output buffer
+                        exmx_.lock ();
+                        tty->clear_interrupt ();
                         int result = cmd_parser (buffer);
-                        if (result == ush_exit)
+                        if (tty->clear_interrupt ())
                           {
-                            // exit command, we must leave now
-                            break;
+                            printf ("^C\n");
                           }
-                        else if (result != ush_ok)
+                        else if (result != ush_ok && result != ush_exit)
                           {
                             printf ("error %d\n", result);
                           }
+                        flush (); // end of command, write out its output
+                        out_->flush ();
+                        exmx_.unlock ();
+                        if (result == ush_exit)
+                          {
+                            // exit command, we must leave now
+                            break;
+                          }
                       }
                   }
                 while (!(c < 0)); // exit on tty error
 
-                // restore the original tty settings
-                tty->tcsetattr (TCSANOW, &tio_orig);
 #if SHELL_USE_READLINE == true
                 rl_->end ();
 #endif
+                // restore the original tty settings, once what is queued
+                // has been sent with the session's
+                tty->tcsetattr (TCSADRAIN, &tio_orig);
               }
             tty->close ();
           }
+        out_ = nullptr;
+        tty = nullptr;
+      }
+
+    // a tty that fails at once would make a caller restarting the session
+    // spin; back off, longer with each failure in a row
+    if (failed)
+      {
+        rtos::sysclock.sleep_for (
+            (SHELL_RETRY_DELAY << backoff_) * rtos::sysclock.frequency_hz
+                / 1000);
+        if (backoff_ < 8)
+          {
+            backoff_++;
+          }
+      }
+    else
+      {
+        backoff_ = 0;
       }
 
     return nullptr;
   }
 
+  /**
+   * @brief Formatted output to the shell's tty. The output is collected in
+   *  the session's buffer and written out with as few writes as possible.
+   * @param fmt: format string, like for printf ().
+   * @return Number of characters output, negative on error.
+   */
   int
   ushell::printf (const char* fmt, ...)
   {
     va_list ap;
+    int result;
 
     va_start(ap, fmt);
-    int result = vdprintf (tty->file_descriptor (), fmt, ap);
+    result = vsnprintf (obuf_ + olen_, sizeof(obuf_) - olen_, fmt, ap);
     va_end(ap);
 
+    if (result >= 0 && (size_t) result >= sizeof(obuf_) - olen_)
+      {
+        // does not fit in what is left, make room and try again
+        if ((result = flush ()) >= 0)
+          {
+            va_start(ap, fmt);
+            result = vsnprintf (obuf_, sizeof(obuf_), fmt, ap);
+            va_end(ap);
+
+            if (result >= 0 && (size_t) result >= sizeof(obuf_))
+              {
+                // larger than the whole buffer, format it separately
+                char* big = new (std::nothrow) char[result + 1];
+                if (big == nullptr)
+                  {
+                    result = -1;
+                  }
+                else
+                  {
+                    va_start(ap, fmt);
+                    result = vsnprintf (big, result + 1, fmt, ap);
+                    va_end(ap);
+                    result = out_->write (big, result);
+                    delete[] big;
+                  }
+              }
+            else if (result > 0)
+              {
+                olen_ = result;
+              }
+          }
+      }
+    else if (result > 0)
+      {
+        olen_ += result;
+      }
+
     return result;
   }
 
+  /**
+   * @brief Read one character of input.
+   * @return The character, 0 at end of file, negative on error.
+   */
   int
   ushell::getchar (void)
   {
     int c = 0, r;
 
-    if ((r = tty->read (&c, 1)) < 0)
+    if ((r = read (&c, 1)) < 0)
       {
         c = r;
       }
@@ -195,118 +339,792 @@ namespace ushell
     return c;
   }
 
+  /**
+   * @brief Read the command's input: the previous stage of a pipeline, or
+   *  the session tty.
+   * @param buf: buffer to return the data.
+   * @param nbyte: buffer length.
+   * @return Number of bytes read, 0 at end of file, negative on error.
+   */
+  int
+  ushell::read (void* buf, size_t nbyte)
+  {
+#if SHELL_PIPE_SUPPORT == true
+    if (in_ != nullptr)
+      {
+        return in_->read (buf, nbyte);
+      }
+#endif
+    if (tty == nullptr)
+      {
+        return 0; // headless, no input
+      }
+
+    flush (); // make sure the prompt, if any, is visible
+    return tty->read (buf, nbyte);
+  }
+
+  /**
+   * @brief Read one line of input; the line terminator is removed. A line
+   *  longer than the buffer is returned in several pieces.
+   * @param buf: buffer to return the line.
+   * @param len: buffer length, including the null terminator.
+   * @param more: if not nullptr, set to true when the line did not fit,
+   *  i.e. the next call returns more of it.
+   * @return Length of the line, or -1 at end of file.
+   */
+  int
+  ushell::getline (char* buf, size_t len, bool* more)
+  {
+    size_t n = 0;
+    int r = 1;
+    bool eol = false;
+    char c;
+
+    while (n + 1 < len && (r = read (&c, 1)) > 0)
+      {
+        if (c == '\n')
+          {
+            eol = true;
+            break;
+          }
+        if (c != '\r')
+          {
+            buf[n++] = c;
+          }
+      }
+    buf[n] = '\0';
+    if (more != nullptr)
+      {
+        *more = !eol && r > 0;
+      }
+
+    return (n == 0 && r <= 0) ? -1 : (int) n;
+  }
+
   int
   ushell::putchar (int c)
   {
     int r;
 
-    if ((r = tty->write (&c, 1)) < 0)
+    if (olen_ >= sizeof(obuf_) && (r = flush ()) < 0)
       {
         c = r;
       }
+    else
+      {
+        obuf_[olen_++] = (char) c;
+      }
 
     return c;
   }
 
+  /**
+   * @brief Unformatted output; like printf (), it goes through the session's
+   *  buffer, but blocks larger than the buffer are passed on directly.
+   * @param buf: data to write.
+   * @param nbyte: number of bytes.
+   * @return Number of bytes written, negative on error.
+   */
+  int
+  ushell::write (const void* buf, size_t nbyte)
+  {
+    int result = nbyte;
+
+    if (nbyte > sizeof(obuf_) - olen_)
+      {
+        if ((result = flush ()) >= 0)
+          {
+            result = nbyte;
+          }
+      }
+    if (result >= 0)
+      {
+        if (nbyte > sizeof(obuf_))
+          {
+            result = out_->write (buf, nbyte);
+          }
+        else
+          {
+            memcpy (obuf_ + olen_, buf, nbyte);
+            olen_ += nbyte;
+          }
+      }
+
+    return result;
+  }
+
+  /**
+   * @brief Write out the buffered output to the current sink.
+   * @return Number of bytes written, negative on error.
+   */
+  int
+  ushell::flush (void)
+  {
+    int result = 0;
+
+    if (olen_)
+      {
+        result = out_->write (obuf_, olen_);
+        olen_ = 0;
+      }
+
+    return result;
+  }
+
+  /**
+   * @brief Execute a command line with its output sent to a given sink, e.g.
+   *  to capture it in memory. It can be used on a shell with no open tty,
+   *  in which case commands reading input get an end of file. On a shell
+   *  running a session, it waits for the command in progress, if any.
+   * @param line: command line; it is modified.
+   * @param sink: destination of the command's output.
+   * @return Result of the command's execution.
+   */
+  int
+  ushell::exec (char* line, output_sink* sink)
+  {
+    exmx_.lock ();
+    output_sink* saved = out_;
+
+#if SHELL_FILE_SUPPORT == true
+    if (*ph.get () == '\0')
+      {
+        ph.set_default ("/flash/");
+      }
+#endif
+
+    flush ();
+    out_ = sink;
+    int result = cmd_parser (line);
+    flush ();
+    out_->flush ();
+    out_ = saved;
+    exmx_.unlock ();
+
+    return result;
+  }
+
   //----------------------------------------------------------------------------
 
   int
   ushell::cmd_parser (char* buff)
   {
-    class ushell_cmd** pclasses;
-    char* pbuff;
-    char* argv[SHELL_MAX_CMD_ARGS];
+    class ushell_cmd* pclass = nullptr;
+#if SHELL_STATIC_COMMANDS == true
+    const static_cmd_t* pstatic;
+#endif
     int result = ush_ok;
 
-    if (*buff != '\0') // ignore empty strings, at least one character is expected
+#if SHELL_FILE_SUPPORT == true
+    char* op;
+    if ((op = tokenizer::find_unquoted (buff, '>')) != nullptr)
       {
-        pbuff = buff;
+        return redirect (buff, op);
+      }
+#endif
+
+#if SHELL_PIPE_SUPPORT == true
+    if (tokenizer::find_unquoted (buff, '|') != nullptr)
+      {
+        return pipeline (buff);
+      }
+#endif
 
-        // extract the command
-        while (*pbuff != ' ' && *pbuff != '\0')
+    // bounded, not sized from the count: that would take a second pass
+    // and a variable length array or the heap; split () still counts past
+    // the end, so that a line with too many arguments is told apart
+    char* argv[SHELL_MAX_CMD_ARGS + 1];
+    int argc = tokenizer::split (buff, argv, SHELL_MAX_CMD_ARGS + 1);
+
+    if (argc > SHELL_MAX_CMD_ARGS)
+      {
+        result = ush_param_invalid; // too many arguments
+      }
+    else if (argc > 0) // ignore empty lines
+      {
+        // look up the command, first in the compile-time registry, if any,
+        // then in the index of linked command classes
+        result = ush_cmd_not_found;
+#if SHELL_STATIC_COMMANDS == true
+        if ((pstatic = find_static_cmd (argv[0])) != nullptr)
           {
-            pbuff++;
+            result = pstatic->handler (this, argc, argv);
           }
-        *pbuff++ = '\0'; // add terminator
-        argv[0] = buff; // first argument is the command itself
+        else
+#endif
+        if ((pclass = find_cmd (argv[0])) != nullptr)
+          {
+            result = pclass->do_cmd (this, argc, argv);
+            release_cmd (pclass);
+          }
+      }
 
-        // iterate all linked command classes
-        result = ush_cmd_not_found;
-        for (pclasses = ushell_cmds_; *pclasses != nullptr; pclasses++)
+    return result;
+  }
+
+#if SHELL_FILE_SUPPORT == true
+  /**
+   * @brief Run a command (or pipeline) with its output redirected to a file,
+   *  "cmd > file" or "cmd >> file" to append. The file is written in blocks
+   *  of the file system's cluster size, aligned to the cluster boundaries
+   *  (statvfs () is only used to learn that size). Only available with
+   *  SHELL_FILE_SUPPORT, there is nowhere to redirect to otherwise.
+   * @param line: command line.
+   * @param op: pointer on the redirection operator within the line.
+   * @return Result of the command's execution, or ush_write_error if the
+   *  command succeeded but not all of its output made it to the file, e.g.
+   *  because the file system is full.
+   */
+  int
+  ushell::redirect (char* line, char* op)
+  {
+    static constexpr size_t path_len = 260;
+
+    bool append = (op[1] == '>');
+    char* target = op + (append ? 2 : 1);
+    char* argv[2];
+    char path[path_len + 1] =
+      { '\0' };
+    int result;
+
+    *op = '\0';
+    if (tokenizer::split (target, argv, 2) != 1)
+      {
+        return ush_param_invalid; // one file name expected
+      }
+    if (ph.to_absolute (argv[0], path, path_len) < 0)
+      {
+        printf ("Path too long: %s\n", argv[0]);
+        return ush_param_invalid;
+      }
+
+    // size the buffer to the cluster, that is the unit FAT writes anyway
+    size_t block = 512;
+    struct statvfs sfs;
+    if (posix::statvfs (path, &sfs) == 0 && sfs.f_bsize)
+      {
+        block = std::min ((size_t) sfs.f_bsize,
+                          (size_t) SHELL_REDIRECT_MAX_BUFFER);
+      }
+
+    off_t offset = 0;
+    struct stat st_buf;
+    if (append && posix::stat (path, &st_buf) == 0)
+      {
+        offset = st_buf.st_size;
+      }
+
+    posix::io* f = posix::open (path,
+                                O_WRONLY | O_CREAT
+                                    | (append ? O_APPEND : O_TRUNC));
+    if (f == nullptr)
+      {
+        printf ("Could not open %s\n", path);
+        return ush_param_invalid;
+      }
+
+    {
+      file_sink file_out
+        { f, block, offset };
+      output_sink* saved = out_;
+
+      flush ();
+      out_ = &file_out;
+      result = cmd_parser (line);
+      flush ();
+      out_ = saved;
+
+      // the output written while the command ran may have failed already,
+      // e.g. with the file system full; the sink remembers it
+      if (file_out.flush () < 0 || file_out.error ())
+        {
+          printf ("Error writing %s: %s\n", path, strerror (file_out.error ()));
+          if (result == ush_ok)
+            {
+              result = ush_write_error;
+            }
+        }
+    }
+    if (f->close () < 0 && result == ush_ok)
+      {
+        printf ("Error closing %s\n", path);
+        result = ush_write_error;
+      }
+
+    return result;
+  }
+#endif
+
+#if SHELL_PIPE_SUPPORT == true
+  /**
+   * @brief Run a pipeline, "cmd1 | cmd2 | ...". The stages are connected by
+   *  bounded pipes and run concurrently: each stage but the last on a thread
+   *  of its own, the last one on the shell's thread.
+   * @param line: command line.
+   * @return Result of the last stage, or of the first failing stage.
+   */
+  int
+  ushell::pipeline (char* line)
+  {
+    char* stages[SHELL_PIPE_MAX_STAGES];
+    stage_t st[SHELL_PIPE_MAX_STAGES - 1] =
+      { };
+    int n = 0, i;
+    int result = ush_ok;
+
+    // split the line at the pipe operators
+    stages[n++] = line;
+    for (char* p; (p = tokenizer::find_unquoted (stages[n - 1], '|'))
+        != nullptr;)
+      {
+        if (n >= SHELL_PIPE_MAX_STAGES)
           {
-            if (!strcasecmp ((*pclasses)->get_cmd_info ()->command, buff))
-              {
-                int argc;
+            return ush_param_invalid;
+          }
+        *p++ = '\0';
+        stages[n++] = p;
+      }
 
-                // valid command, parse parameters, if any
-                for (argc = 1; argc < SHELL_MAX_CMD_ARGS; argc++)
+    // set up the stages running on threads
+    for (i = 0; i < n - 1; i++)
+      {
+        st[i].line = stages[i];
+        st[i].in = (i > 0) ? st[i - 1].out : nullptr;
+        st[i].out = new (std::nothrow) ring_pipe
+          { SHELL_PIPE_BUFFER_LEN };
+        st[i].ush = new (std::nothrow) ushell
+          { this };
+        if (st[i].out == nullptr || !st[i].out->valid ()
+            || st[i].ush == nullptr)
+          {
+            result = out_of_memory;
+            break;
+          }
+        st[i].ush->in_ = st[i].in;
+        st[i].ush->out_ = st[i].out;
+      }
+
+    if (result == ush_ok)
+      {
+        flush (); // keep the order of the output
+        rtos::thread::attributes attr;
+        attr.th_stack_size_bytes = SHELL_PIPE_STACK_SIZE;
+
+        for (i = 0; i < n - 1; i++)
+          {
+            st[i].th = new (std::nothrow) rtos::thread
+              { "ush-pipe", stage_th, &st[i], attr };
+            if (st[i].th == nullptr)
+              {
+                // no stage, the next one gets an immediate end of file
+                st[i].result = out_of_memory;
+                st[i].out->close_write ();
+                if (st[i].in != nullptr)
                   {
-                    if (*pbuff == '\0')
-                      {
-                        break;          // end of line reached
-                      }
-                    if (*pbuff == '\"')
-                      {
-                        pbuff++;        // skip the "
-                        argv[argc] = pbuff;
-                        while (*pbuff != '\"' && *pbuff != '\0')
-                          {
-                            pbuff++;
-                          }
-                        *pbuff++ = '\0';
-                        if (*pbuff != '\0')  // if not end of line...
-                          {
-                            pbuff++;    // skip the trailing space
-                          }
-                      }
-                    else
-                      {
-                        while (*pbuff == ' ' || *pbuff == '\t')
-                          {
-                            pbuff++;    // skip leading white spaces, if any
-                          }
-                        if (*pbuff == '\0')
-                          {
-                            break;      // end of line, exit
-                          }
-                        argv[argc] = pbuff;
-                        while (*pbuff != ' ' && *pbuff != '\0')
-                          {
-                            pbuff++;
-                          }
-                        *pbuff++ = '\0';
-                      }
+                    st[i].in->close_read ();
                   }
-                argv[argc] = nullptr;
-                result = (*pclasses)->do_cmd (this, argc, argv);
-                break;
               }
           }
+
+        // the last stage runs here, reading from the last pipe
+        in_ = st[n - 2].out;
+        result = cmd_parser (stages[n - 1]);
+        in_->close_read ();
+        in_ = nullptr;
+
+        for (i = n - 2; i >= 0; i--)
+          {
+            if (st[i].th != nullptr)
+              {
+                st[i].th->join ();
+                delete st[i].th;
+              }
+            if (result == ush_ok && st[i].result != ush_ok
+                && st[i].result != ush_exit)
+              {
+                result = st[i].result;
+              }
+          }
+      }
+
+    for (i = 0; i < n - 1; i++)
+      {
+        delete st[i].ush;
+        delete st[i].out;
       }
 
     return result;
   }
 
-  bool
-  ushell::link_cmd (class ushell_cmd* ucmd)
+  /**
+   * @brief Thread function running a stage of a pipeline.
+   * @param args: pointer on the stage's descriptor.
+   * @return nullptr.
+   */
+  void*
+  ushell::stage_th (void* args)
   {
-    bool result = false;
-    int i;
+    stage_t* st = static_cast<stage_t*> (args);
 
-    for (i = 0; i < SHELL_MAX_COMMANDS; i++)
+    st->result = st->ush->cmd_parser (st->line);
+    st->ush->flush ();
+    st->out->close_write ();
+    if (st->in != nullptr)
       {
-        if (ushell_cmds_[i] == nullptr)
+        st->in->close_read (); // stop the previous stage, if still running
+      }
+
+    return nullptr;
+  }
+#endif
+
+  /**
+   * @brief Find a linked command by name (case insensitive). The command is
+   *  returned held, so that it cannot be unlinked while it runs; the caller
+   *  must pass it to release_cmd () when done.
+   * @param name: command name.
+   * @return Pointer on the command class, or nullptr if not found.
+   */
+  ushell_cmd*
+  ushell::find_cmd (const char* name)
+  {
+    ushell_cmd* pclass;
+
+    if (pending_ != nullptr)
+      {
+        index_pending (&pending_);
+      }
+
+    pclass = lookup_cmd (name);
+    if (pclass == nullptr && unnamed_ != nullptr)
+      {
+        // it may be a command which got its name late
+        index_pending (&unnamed_);
+        pclass = lookup_cmd (name);
+      }
+
+    return pclass;
+  }
+
+  /**
+   * @brief Look a command up in the hash index; the bucket is scanned in a
+   *  critical section, the chains are short. On a name clash, the command
+   *  linked first is the one found.
+   * @param name: command name.
+   * @return Pointer on the command class, held, or nullptr if not found.
+   */
+  ushell_cmd*
+  ushell::lookup_cmd (const char* name)
+  {
+    ushell_cmd* found = nullptr;
+    rtos::scheduler::critical_section scs;
+
+    for (ushell_cmd* pclass = cmd_index_[hash (name)
+        & (SHELL_CMD_INDEX_LEN - 1)]; pclass != nullptr;
+        pclass = pclass->hash_next_)
+      {
+        if ((found == nullptr || pclass->order_ < found->order_)
+            && !strcasecmp (pclass->get_cmd_info ()->command, name))
           {
-            ushell_cmds_[i] = ucmd;
-            result = true;
-            break;
+            found = pclass;
+          }
+      }
+    if (found != nullptr)
+      {
+        found->users_++;
+      }
+
+    return found;
+  }
+
+#if SHELL_STATIC_COMMANDS == true
+  /**
+   * @brief Find a command in the compile-time registry (binary search, the
+   *  table is sorted by command name).
+   * @param name: command name.
+   * @return Pointer on the command descriptor, or nullptr if not found.
+   */
+  const static_cmd_t*
+  ushell::find_static_cmd (const char* name)
+  {
+    size_t lo = 0, hi = static_cmds_count;
+
+    while (lo < hi)
+      {
+        size_t mid = (lo + hi) / 2;
+        int cmp = cmd_name_cmp (static_cmds[mid].command, name);
+        if (cmp == 0)
+          {
+            return &static_cmds[mid];
+          }
+        if (cmp < 0)
+          {
+            lo = mid + 1;
+          }
+        else
+          {
+            hi = mid;
           }
       }
 
-    // check if the table overflowed
-    assert(i < SHELL_MAX_COMMANDS);
+    return nullptr;
+  }
+#endif
+
+  /**
+   * @brief Move the pending commands into the hash index. The command names
+   *  are set by the derived classes' constructors, after link_cmd () was
+   *  called, therefore commands are indexed lazily, on the next lookup. A
+   *  command whose name is not set yet is parked on the unnamed list, which
+   *  is only looked at when a lookup fails.
+   * @param list: the pending or the unnamed list.
+   */
+  void
+  ushell::index_pending (ushell_cmd** list)
+  {
+    rtos::scheduler::critical_section scs;
 
-    return result;
+    ushell_cmd* next;
+    for (ushell_cmd* ucmd = *list; ucmd != nullptr; ucmd = next)
+      {
+        next = ucmd->hash_next_;
+        const char* name = ucmd->get_cmd_info ()->command;
+        if (name != nullptr)
+          {
+            hlist_del (ucmd);
+            hlist_add (&cmd_index_[hash (name) & (SHELL_CMD_INDEX_LEN - 1)],
+                       ucmd);
+          }
+        else if (list != &unnamed_)
+          {
+            hlist_del (ucmd);
+            hlist_add (&unnamed_, ucmd);
+          }
+      }
+  }
+
+  /**
+   * @brief Case insensitive FNV-1a hash of a command name.
+   * @param name: command name.
+   * @return Hash value.
+   */
+  uint32_t
+  ushell::hash (const char* name)
+  {
+    uint32_t h = 2166136261u;
+
+    while (*name)
+      {
+        h ^= (uint8_t) tolower ((uint8_t) *name++);
+        h *= 16777619u;
+      }
+
+    return h;
+  }
+
+  /**
+   * @brief Add a command to the list of available commands. It is normally
+   *  called by the ushell_cmd constructor. Never fails.
+   * @param ucmd: command to add.
+   * @return true if linked, false if it was already linked.
+   */
+  bool
+  ushell::link_cmd (class ushell_cmd* ucmd)
+  {
+    rtos::scheduler::critical_section scs;
+
+    if (ucmd->linked_)
+      {
+        return false;
+      }
+
+    // append to the registry, keeping the link order
+    ucmd->order_ = link_order_++;
+    ucmd->next_ = nullptr;
+    ucmd->prev_ = last_;
+    if (last_ != nullptr)
+      {
+        last_->next_ = ucmd;
+      }
+    else
+      {
+        first_ = ucmd;
+      }
+    last_ = ucmd;
+
+    hlist_add (&pending_, ucmd);
+    ucmd->linked_ = true;
+
+    return true;
+  }
+
+  /**
+   * @brief Remove a command from the list of available commands. It is
+   *  called by the ushell_cmd destructor, and may be called earlier, e.g.
+   *  from the destructor of the derived class. It returns after the
+   *  command's running invocations have returned and the iterations
+   *  holding it have moved on; therefore a command must not unlink itself
+   *  from its do_cmd ().
+   * @param ucmd: command to remove.
+   */
+  void
+  ushell::unlink_cmd (class ushell_cmd* ucmd)
+  {
+    rtos::semaphore_binary released
+      { "ush-unlink", 0 };
+    bool wait;
+
+    {
+      rtos::scheduler::critical_section scs;
+
+      if (!ucmd->linked_)
+        {
+          return;
+        }
+
+      // lookups no longer find it, iterations step over it
+      hlist_del (ucmd);
+      ucmd->linked_ = false;
+
+      // only those already holding the command are waited for, new ones
+      // cannot get it; the last one to let it go posts the semaphore
+      wait = (ucmd->users_ != 0);
+      ucmd->released_ = wait ? &released : nullptr;
+    }
+
+    if (wait)
+      {
+        released.wait ();
+      }
+
+    rtos::scheduler::critical_section scs;
+
+    if (ucmd->prev_ != nullptr)
+      {
+        ucmd->prev_->next_ = ucmd->next_;
+      }
+    else
+      {
+        first_ = ucmd->next_;
+      }
+    if (ucmd->next_ != nullptr)
+      {
+        ucmd->next_->prev_ = ucmd->prev_;
+      }
+    else
+      {
+        last_ = ucmd->prev_;
+      }
+    ucmd->next_ = ucmd->prev_ = nullptr;
+  }
+
+  /**
+   * @brief Return the first linked command, held.
+   * @return Pointer on the command, or nullptr if there are none.
+   */
+  ushell_cmd*
+  ushell::first_cmd (void)
+  {
+    rtos::scheduler::critical_section scs;
+
+    ushell_cmd* ucmd = first_;
+    while (ucmd != nullptr && !ucmd->linked_)
+      {
+        ucmd = ucmd->next_;
+      }
+    if (ucmd != nullptr)
+      {
+        ucmd->users_++;
+      }
+
+    return ucmd;
+  }
+
+  /**
+   * @brief Release a command and return the next linked one, held.
+   * @param ucmd: current command.
+   * @return Pointer on the next command, or nullptr at the end of the list.
+   */
+  ushell_cmd*
+  ushell::next_cmd (ushell_cmd* ucmd)
+  {
+    rtos::scheduler::critical_section scs;
+
+    // the current command is held, thus still in the list
+    ushell_cmd* next = ucmd->next_;
+    while (next != nullptr && !next->linked_)
+      {
+        next = next->next_;
+      }
+    if (next != nullptr)
+      {
+        next->users_++;
+      }
+    drop (ucmd);
+
+    return next;
+  }
+
+  /**
+   * @brief Release a command returned by find_cmd (), first_cmd () or
+   *  next_cmd ().
+   * @param ucmd: the command.
+   */
+  void
+  ushell::release_cmd (ushell_cmd* ucmd)
+  {
+    rtos::scheduler::critical_section scs;
+    drop (ucmd);
+  }
+
+  /**
+   * @brief Let go of a held command; the last one to let go of a command
+   *  being unlinked wakes up unlink_cmd (). Call it in a critical section.
+   * @param ucmd: the command.
+   */
+  void
+  ushell::drop (ushell_cmd* ucmd)
+  {
+    if (--ucmd->users_ == 0 && ucmd->released_ != nullptr)
+      {
+        ucmd->released_->post ();
+        ucmd->released_ = nullptr;
+      }
+  }
+
+  /**
+   * @brief Insert a command at the head of a hash bucket or of a pending
+   *  list. Call it in a critical section.
+   * @param head: list head.
+   * @param ucmd: command to insert.
+   */
+  void
+  ushell::hlist_add (ushell_cmd** head, ushell_cmd* ucmd)
+  {
+    ucmd->hash_next_ = *head;
+    if (*head != nullptr)
+      {
+        (*head)->hash_pprev_ = &ucmd->hash_next_;
+      }
+    ucmd->hash_pprev_ = head;
+    *head = ucmd;
+  }
+
+  /**
+   * @brief Remove a command from its hash bucket or pending list. Call it in
+   *  a critical section.
+   * @param ucmd: command to remove.
+   */
+  void
+  ushell::hlist_del (ushell_cmd* ucmd)
+  {
+    *ucmd->hash_pprev_ = ucmd->hash_next_;
+    if (ucmd->hash_next_ != nullptr)
+      {
+        ucmd->hash_next_->hash_pprev_ = ucmd->hash_pprev_;
+      }
+    ucmd->hash_pprev_ = nullptr;
   }
 
   //----------------------------------------------------------------------------
@@ -314,12 +1132,16 @@ namespace ushell
   ushell_cmd::ushell_cmd (void)
   {
     trace::printf ("%s() %p\n", __func__, this);
+    info_.command = nullptr;    // set by the derived class
+    info_.help_text = nullptr;
     ushell::link_cmd (this);
   }
 
   ushell_cmd::~ushell_cmd ()
   {
     trace::printf ("%s() %p\n", __func__, this);
+    // normally done already by the derived class, while it was whole
+    ushell::unlink_cmd (this);
   }
 
   ushell_cmd::cmd_info_t*